@@ -6,6 +6,8 @@
 #include <common.h>
 #include <bootstage.h>
 #include <command.h>
+#include <env.h>
+#include <mapmem.h>
 
 static int do_bootstage_report(struct cmd_tbl *cmdtp, int flag, int argc,
 			       char *const argv[])
@@ -59,10 +61,46 @@ static int do_bootstage_stash(struct cmd_tbl *cmdtp, int flag, int argc,
 	return 0;
 }
 
+static int do_bootstage_export(struct cmd_tbl *cmdtp, int flag, int argc,
+			       char *const argv[])
+{
+	enum bootstage_export_fmt fmt;
+	ulong addr, size;
+	char *buf;
+	int ret;
+
+	if (argc < 2 || argc == 3)
+		return CMD_RET_USAGE;
+	if (!strcmp(argv[1], "json"))
+		fmt = BOOTSTAGE_EXPORT_JSON;
+	else if (!strcmp(argv[1], "csv"))
+		fmt = BOOTSTAGE_EXPORT_CSV;
+	else
+		return CMD_RET_USAGE;
+
+	if (argc < 4)
+		return bootstage_export(fmt, NULL, 0) < 0 ?
+			CMD_RET_FAILURE : CMD_RET_SUCCESS;
+
+	addr = simple_strtoul(argv[2], NULL, 16);
+	size = simple_strtoul(argv[3], NULL, 16);
+	buf = map_sysmem(addr, size);
+	ret = bootstage_export(fmt, buf, size);
+	unmap_sysmem(buf);
+	if (ret < 0) {
+		printf("Not enough space for bootstage export\n");
+		return CMD_RET_FAILURE;
+	}
+	env_set_hex("filesize", ret);
+
+	return 0;
+}
+
 static struct cmd_tbl cmd_bootstage_sub[] = {
 	U_BOOT_CMD_MKENT(report, 2, 1, do_bootstage_report, "", ""),
 	U_BOOT_CMD_MKENT(stash, 4, 0, do_bootstage_stash, "", ""),
 	U_BOOT_CMD_MKENT(unstash, 4, 0, do_bootstage_stash, "", ""),
+	U_BOOT_CMD_MKENT(export, 4, 0, do_bootstage_export, "", ""),
 };
 
 /*
@@ -87,10 +125,12 @@ static int do_boostage(struct cmd_tbl *cmdtp, int flag, int argc,
 }
 
 
-U_BOOT_CMD(bootstage, 4, 1, do_boostage,
+U_BOOT_CMD(bootstage, 5, 1, do_boostage,
 	"Boot stage command",
 	" - check boot progress and timing\n"
 	"report                      - Print a report\n"
 	"stash [<start> [<size>]]    - Stash data into memory\n"
-	"unstash [<start> [<size>]]  - Unstash data from memory"
+	"unstash [<start> [<size>]]  - Unstash data from memory\n"
+	"export json|csv [<start> <size>]\n"
+	"                            - Export data to the console or memory"
 );
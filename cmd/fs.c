@@ -41,6 +41,25 @@ U_BOOT_CMD(
 	"      If 'pos' is 0 or omitted, the file is read from the start."
 )
 
+#ifdef CONFIG_CMD_GZLOAD
+static int do_gzload_wrapper(struct cmd_tbl *cmdtp, int flag, int argc,
+			     char *const argv[])
+{
+	return do_gzload(cmdtp, flag, argc, argv, FS_TYPE_ANY);
+}
+
+U_BOOT_CMD(
+	gzload,	6,	0,	do_gzload_wrapper,
+	"load and decompress a gzipped file from a filesystem",
+	"<interface> <dev[:part]> <addr> <filename> [maxsize]\n"
+	"    - Read gzipped file 'filename' from partition 'part' on device\n"
+	"      type 'interface' instance 'dev' and decompress it to address\n"
+	"      'addr' in memory, a piece at a time. 'maxsize' limits the size\n"
+	"      of the decompressed data, which is otherwise limited by the\n"
+	"      reserved memory above 'addr'."
+);
+#endif
+
 static int do_save_wrapper(struct cmd_tbl *cmdtp, int flag, int argc,
 			   char *const argv[])
 {
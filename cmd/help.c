@@ -29,8 +29,13 @@ U_BOOT_CMD(
 );
 
 #ifdef CONFIG_CMDLINE
-/* This does not use the U_BOOT_CMD macro as ? can't be used in symbol names */
-ll_entry_declare(struct cmd_tbl, question_mark, cmd) = {
+/*
+ * This does not use the U_BOOT_CMD macro as ? can't be used in symbol names.
+ * The linker sorts commands by entry name and find_cmd() expects that to
+ * match the order of the command names. '?' comes before any letter, so use
+ * an entry name which sorts before the other commands too.
+ */
+ll_entry_declare(struct cmd_tbl, A_question_mark, cmd) = {
 	"?",	CONFIG_SYS_MAXARGS, cmd_always_repeatable,	do_help,
 	"alias for 'help'",
 #ifdef  CONFIG_SYS_LONGHELP
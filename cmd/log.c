@@ -95,6 +95,19 @@ static int do_log_rec(struct cmd_tbl *cmdtp, int flag, int argc,
 	return 0;
 }
 
+#ifdef CONFIG_LOG_BUF
+static int do_log_dump(struct cmd_tbl *cmdtp, int flag, int argc,
+		       char *const argv[])
+{
+	if (log_buf_dump()) {
+		printf("No log buffer\n");
+		return CMD_RET_FAILURE;
+	}
+
+	return 0;
+}
+#endif
+
 static struct cmd_tbl log_sub[] = {
 	U_BOOT_CMD_MKENT(level, CONFIG_SYS_MAXARGS, 1, do_log_level, "", ""),
 #ifdef CONFIG_LOG_TEST
@@ -102,6 +115,9 @@ static struct cmd_tbl log_sub[] = {
 #endif
 	U_BOOT_CMD_MKENT(format, CONFIG_SYS_MAXARGS, 1, do_log_format, "", ""),
 	U_BOOT_CMD_MKENT(rec, CONFIG_SYS_MAXARGS, 1, do_log_rec, "", ""),
+#ifdef CONFIG_LOG_BUF
+	U_BOOT_CMD_MKENT(dump, 1, 1, do_log_dump, "", ""),
+#endif
 };
 
 static int do_log(struct cmd_tbl *cmdtp, int flag, int argc, char *const argv[])
@@ -134,6 +150,9 @@ static char log_help_text[] =
 	"\tor 'default', equivalent to 'fm', or 'all' for all\n"
 	"log rec <category> <level> <file> <line> <func> <message> - "
 		"output a log record"
+#ifdef CONFIG_LOG_BUF
+	"\nlog dump - show the records in the log buffer"
+#endif
 	;
 #endif
 
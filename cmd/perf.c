@@ -0,0 +1,57 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Show and reset the hot-path performance counters
+ */
+
+#include <common.h>
+#include <command.h>
+#include <perf_counter.h>
+#include <time.h>
+
+static int do_perf_show(struct cmd_tbl *cmdtp, int flag, int argc,
+			char *const argv[])
+{
+	perf_show();
+
+	return 0;
+}
+
+static int do_perf_reset(struct cmd_tbl *cmdtp, int flag, int argc,
+			 char *const argv[])
+{
+	perf_reset();
+
+	return 0;
+}
+
+static int do_perf_stat(struct cmd_tbl *cmdtp, int flag, int argc,
+			char *const argv[])
+{
+	int repeatable = 0;
+	ulong start;
+	int ret;
+
+	if (argc < 2)
+		return CMD_RET_USAGE;
+
+	perf_reset();
+	start = timer_get_us();
+	ret = cmd_process(0, argc - 1, argv + 1, &repeatable, NULL);
+	printf("\nElapsed: %lu us\n", timer_get_us() - start);
+	perf_show();
+
+	return ret;
+}
+
+static char perf_help_text[] =
+	"show               - show the performance counters\n"
+	"perf reset              - set all counters to zero\n"
+	"perf stat <cmd> [args]  - run a command and show the counters for it";
+
+U_BOOT_CMD_WITH_SUBCMDS(perf, "I/O and allocation performance counters",
+			perf_help_text,
+			U_BOOT_SUBCMD_MKENT(show, 1, 1, do_perf_show),
+			U_BOOT_SUBCMD_MKENT(reset, 1, 0, do_perf_reset),
+			U_BOOT_SUBCMD_MKENT(stat, CONFIG_SYS_MAXARGS, 0,
+					    do_perf_stat),
+);
@@ -10,6 +10,8 @@
 #include <trace.h>
 #include <asm/io.h>
 
+DECLARE_GLOBAL_DATA_PTR;
+
 static int get_args(int argc, char *const argv[], char **buff,
 		    size_t *buff_ptr, size_t *buff_size)
 {
@@ -63,9 +65,11 @@ static int create_call_list(int argc, char *const argv[])
 
 	avail = buff_size - buff_ptr;
 	err = trace_list_calls(buff + buff_ptr, avail, &needed);
-	if (err)
-		printf("Error: truncated (%#zx bytes needed)\n", needed);
-	used = min(avail, (size_t)needed);
+	if (err) {
+		printf("Error: buffer too small (%#zx bytes needed)\n", needed);
+		return 0;
+	}
+	used = needed;
 	printf("Call list dumped to %08lx, size %#zx\n",
 	       (ulong)map_to_sysmem(buff + buff_ptr), used);
 
@@ -76,12 +80,48 @@ static int create_call_list(int argc, char *const argv[])
 	return 0;
 }
 
+static int set_filter(int argc, char *const argv[])
+{
+	ulong start, size;
+	bool include;
+	int ret;
+
+	if (argc < 3)
+		return CMD_RET_USAGE;
+	if (!strcmp(argv[2], "reset")) {
+		start = 0;
+		size = gd->mon_len;
+		include = true;
+	} else {
+		if (argc < 5)
+			return CMD_RET_USAGE;
+		if (!strcmp(argv[2], "include"))
+			include = true;
+		else if (!strcmp(argv[2], "exclude"))
+			include = false;
+		else
+			return CMD_RET_USAGE;
+		start = simple_strtoul(argv[3], NULL, 16);
+		size = simple_strtoul(argv[4], NULL, 16);
+	}
+
+	ret = trace_set_filter(start, size, include);
+	if (ret) {
+		printf("Cannot set filter (err=%d)\n", ret);
+		return CMD_RET_FAILURE;
+	}
+
+	return 0;
+}
+
 int do_trace(struct cmd_tbl *cmdtp, int flag, int argc, char *const argv[])
 {
 	const char *cmd = argc < 2 ? NULL : argv[1];
 
 	if (!cmd)
 		return cmd_usage(cmdtp);
+	if (!strcmp(cmd, "filter"))
+		return set_filter(argc, argv);
 	switch (*cmd) {
 	case 'p':
 		trace_set_enabled(0);
@@ -100,6 +140,11 @@ int do_trace(struct cmd_tbl *cmdtp, int flag, int argc, char *const argv[])
 	case 's':
 		trace_print_stats();
 		break;
+	case 'd':
+		if (argc < 3)
+			return CMD_RET_USAGE;
+		trace_set_depth_limit(simple_strtoul(argv[2], NULL, 10));
+		break;
 	default:
 		return CMD_RET_USAGE;
 	}
@@ -108,12 +153,16 @@ int do_trace(struct cmd_tbl *cmdtp, int flag, int argc, char *const argv[])
 }
 
 U_BOOT_CMD(
-	trace,	4,	1,	do_trace,
+	trace,	5,	1,	do_trace,
 	"trace utility commands",
 	"stats                        - display tracing statistics\n"
 	"trace pause                        - pause tracing\n"
 	"trace resume                       - resume tracing\n"
 	"trace funclist [<addr> <size>]     - dump function list into buffer\n"
 	"trace calls  [<addr> <size>]       "
-		"- dump function call trace into buffer"
+		"- dump function call trace into buffer\n"
+	"trace depth <n>                    - only trace calls up to depth n\n"
+	"trace filter include|exclude <offset> <size>\n"
+	"                                   - select functions to trace\n"
+	"trace filter reset                 - trace all functions"
 );
@@ -22,6 +22,7 @@
 #if defined(CONFIG_CMD_USB)
 #include <usb.h>
 #endif
+#include <video.h>
 #else
 #include "mkimage.h"
 #endif
@@ -432,6 +433,10 @@ ulong bootm_disable_interrupts(void)
 	 * details see the OpenHCI specification.
 	 */
 	usb_stop();
+#endif
+#if CONFIG_IS_ENABLED(DM_VIDEO)
+	/* The OS expects the display at the start of the frame buffer */
+	video_unpan_all();
 #endif
 	return iflag;
 }
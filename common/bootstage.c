@@ -14,6 +14,7 @@
 #include <hang.h>
 #include <log.h>
 #include <malloc.h>
+#include <perf_counter.h>
 #include <sort.h>
 #include <spl.h>
 #include <linux/compiler.h>
@@ -23,6 +24,8 @@ DECLARE_GLOBAL_DATA_PTR;
 
 enum {
 	RECORD_COUNT = CONFIG_VAL(BOOTSTAGE_RECORD_COUNT),
+	SPAN_COUNT = CONFIG_VAL(BOOTSTAGE_SPAN_COUNT),
+	SPAN_NAME_LEN = 24,
 };
 
 struct bootstage_record {
@@ -33,10 +36,42 @@ struct bootstage_record {
 	enum bootstage_id id;
 };
 
+/* Flags for each span */
+enum bootstage_span_flags {
+	BOOTSTAGE_SPANF_OPEN	= 1 << 0,	/* Started and not yet ended */
+};
+
+/*
+ * An interval of time, which may contain other spans. The name is held in
+ * the record so that it survives relocation and devices being removed.
+ */
+struct bootstage_span {
+	u32 start_us;		/* Time when the span was first started */
+	u32 last_us;		/* Time when the span was last started */
+	u32 time_us;		/* Total time spent in the span */
+	s16 parent;		/* Number of the enclosing span, or -1 if none */
+	u16 count;		/* Number of times the span was started */
+	u8 type;		/* enum bootstage_span_type */
+	u8 flags;		/* enum bootstage_span_flags */
+	char name[SPAN_NAME_LEN];
+};
+
 struct bootstage_data {
 	uint rec_count;
 	uint next_id;
 	struct bootstage_record record[RECORD_COUNT];
+	uint span_count;
+	uint span_overflow;	/* Number of spans which did not fit */
+	int cur_span;		/* Innermost open span, or -1 if none */
+	struct bootstage_span span[SPAN_COUNT];
+};
+
+static const char *const span_type_name[BOOTSTAGE_SPAN_TYPE_COUNT] = {
+	[BOOTSTAGE_SPAN_USER]	= "user",
+	[BOOTSTAGE_SPAN_PROBE]	= "probe",
+	[BOOTSTAGE_SPAN_READ]	= "read",
+	[BOOTSTAGE_SPAN_DECOMP]	= "decomp",
+	[BOOTSTAGE_SPAN_VERIFY]	= "verify",
 };
 
 enum {
@@ -217,6 +252,68 @@ uint32_t bootstage_accum(enum bootstage_id id)
 	return duration;
 }
 
+int bootstage_span_begin(enum bootstage_span_type type, const char *name)
+{
+	struct bootstage_data *data = gd->bootstage;
+	struct bootstage_span *span;
+	u32 now;
+	int num;
+
+	/* Let the compiler drop all of this if spans are disabled */
+	if (!SPAN_COUNT)
+		return -ENOSPC;
+	if (!data)
+		return -ENOENT;
+	now = timer_get_boot_us();
+	if (!name)
+		name = "";
+	if (type >= BOOTSTAGE_SPAN_TYPE_COUNT)
+		type = BOOTSTAGE_SPAN_USER;
+
+	/* Merge with the previous span if it is the same operation again */
+	num = data->span_count - 1;
+	span = num >= 0 ? &data->span[num] : NULL;
+	if (span && span->parent == data->cur_span && span->type == type &&
+	    !(span->flags & BOOTSTAGE_SPANF_OPEN) &&
+	    !strncmp(span->name, name, SPAN_NAME_LEN - 1) &&
+	    span->count < U16_MAX) {
+		span->count++;
+	} else {
+		if (data->span_count == SPAN_COUNT) {
+			data->span_overflow++;
+			return -ENOSPC;
+		}
+		num = data->span_count++;
+		span = &data->span[num];
+		span->start_us = now;
+		span->time_us = 0;
+		span->parent = data->cur_span;
+		span->count = 1;
+		span->type = type;
+		strlcpy(span->name, name, SPAN_NAME_LEN);
+	}
+	span->last_us = now;
+	span->flags = BOOTSTAGE_SPANF_OPEN;
+	data->cur_span = num;
+
+	return num;
+}
+
+void bootstage_span_end(int num)
+{
+	struct bootstage_data *data = gd->bootstage;
+	struct bootstage_span *span;
+
+	if (!SPAN_COUNT || !data || num < 0 || num >= data->span_count)
+		return;
+	span = &data->span[num];
+	if (!(span->flags & BOOTSTAGE_SPANF_OPEN))
+		return;
+	span->time_us += (u32)timer_get_boot_us() - span->last_us;
+	span->flags &= ~BOOTSTAGE_SPANF_OPEN;
+	data->cur_span = span->parent;
+}
+
 /**
  * Get a record name as a printable string
  *
@@ -326,6 +423,51 @@ int bootstage_fdt_add_report(void)
 }
 #endif
 
+/* Get the nesting depth of a span */
+static int get_span_depth(struct bootstage_data *data, int num)
+{
+	int depth = 0;
+
+	while (data->span[num].parent >= 0) {
+		num = data->span[num].parent;
+		depth++;
+	}
+
+	return depth;
+}
+
+/* Get the time spent in a span, including the current run if still open */
+static u32 get_span_time(const struct bootstage_span *span)
+{
+	if (span->flags & BOOTSTAGE_SPANF_OPEN)
+		return span->time_us + (u32)timer_get_boot_us() - span->last_us;
+
+	return span->time_us;
+}
+
+static void print_spans(struct bootstage_data *data)
+{
+	int i;
+
+	printf("\nSpans (%d records):\n", data->span_count);
+	printf("%11s%11s  %s\n", "Start", "Elapsed", "Span");
+	for (i = 0; i < data->span_count; i++) {
+		const struct bootstage_span *span = &data->span[i];
+
+		print_grouped_ull(span->start_us, BOOTSTAGE_DIGITS);
+		print_grouped_ull(get_span_time(span), BOOTSTAGE_DIGITS);
+		printf("  %*s%s %s", get_span_depth(data, i) * 2, "",
+		       span_type_name[span->type], span->name);
+		if (span->count > 1)
+			printf(" (x%d)", span->count);
+		printf("\n");
+	}
+	if (data->span_overflow)
+		printf("Overflowed span table by %d entries\n"
+		       "Please increase CONFIG_(SPL_)BOOTSTAGE_SPAN_COUNT\n",
+		       data->span_overflow);
+}
+
 void bootstage_report(void)
 {
 	struct bootstage_data *data = gd->bootstage;
@@ -356,6 +498,159 @@ void bootstage_report(void)
 		if (rec->start_us)
 			prev = print_time_record(rec, -1);
 	}
+
+	if (data->span_count)
+		print_spans(data);
+
+	if (CONFIG_IS_ENABLED(PERF_COUNTERS)) {
+		puts("\nPerformance counters:\n");
+		perf_show();
+	}
+}
+
+/* Destination for bootstage_export() */
+struct export_info {
+	enum bootstage_export_fmt fmt;
+	char *buf;		/* Buffer to write to, or NULL for the console */
+	int size;		/* Size of buffer */
+	int len;		/* Number of bytes needed so far */
+};
+
+static void export_printf(struct export_info *exp, const char *fmt, ...)
+{
+	va_list args;
+	int len;
+
+	va_start(args, fmt);
+	if (exp->buf) {
+		int pos = min(exp->len, exp->size);
+
+		len = vsnprintf(exp->buf + pos, exp->size - pos, fmt, args);
+	} else {
+		len = vprintf(fmt, args);
+	}
+	va_end(args);
+	exp->len += len;
+}
+
+/* Write a string, quoted as needed for the export format */
+static void export_str(struct export_info *exp, const char *str)
+{
+	bool json = exp->fmt == BOOTSTAGE_EXPORT_JSON;
+
+	export_printf(exp, "\"");
+	for (; *str; str++) {
+		if (*str == '"')
+			export_printf(exp, json ? "\\\"" : "\"\"");
+		else if (*str == '\\' && json)
+			export_printf(exp, "\\\\");
+		else if ((u8)*str < ' ')
+			export_printf(exp, " ");
+		else
+			export_printf(exp, "%c", *str);
+	}
+	export_printf(exp, "\"");
+}
+
+/* Write the performance counters, named as <subsys>.<counter> */
+static void export_counters(struct export_info *exp)
+{
+	bool json = exp->fmt == BOOTSTAGE_EXPORT_JSON;
+	const char *sep = "";
+	char name[30];
+	int sys, cnt;
+
+	if (json)
+		export_printf(exp, ",\n\"counters\": {");
+	for (sys = 0; sys < PERF_SUBSYS_COUNT; sys++) {
+		for (cnt = 0; cnt < PERF_CNT_COUNT; cnt++) {
+			const char *cnt_name = perf_get_counter_name(sys, cnt);
+
+			if (!cnt_name)
+				continue;
+			snprintf(name, sizeof(name), "%s.%s",
+				 perf_get_subsys_name(sys), cnt_name);
+			if (json)
+				export_printf(exp, "%s\n", sep);
+			else
+				export_printf(exp, "counter,,,");
+			export_str(exp, name);
+			export_printf(exp, json ? ": %llu" : ",,,%llu\n",
+				      (unsigned long long)perf_get(sys, cnt));
+			sep = ",";
+		}
+	}
+	if (json)
+		export_printf(exp, "\n}");
+}
+
+int bootstage_export(enum bootstage_export_fmt fmt, char *buf, int size)
+{
+	struct bootstage_data *data = gd->bootstage;
+	struct export_info exp = { .fmt = fmt, .buf = buf, .size = size };
+	bool json = fmt == BOOTSTAGE_EXPORT_JSON;
+	const char *sep = "";
+	char name[20];
+	int i;
+
+	if (json)
+		export_printf(&exp, "{\"records\": [");
+	else
+		export_printf(&exp, "type,id,parent,name,start_us,time_us,count\n");
+
+	for (i = 0; i < data->rec_count; i++) {
+		const struct bootstage_record *rec = &data->record[i];
+		const char *type = rec->start_us ? "accum" : "mark";
+
+		if (rec->id != BOOTSTAGE_ID_AWAKE && rec->time_us == 0)
+			continue;
+		if (json)
+			export_printf(&exp, "%s\n{\"type\": \"%s\", \"id\": %d, \"name\": ",
+				      sep, type, rec->id);
+		else
+			export_printf(&exp, "%s,%d,,", type, rec->id);
+		export_str(&exp, get_record_name(name, sizeof(name), rec));
+		if (json)
+			export_printf(&exp, ", \"%s\": %lu}",
+				      rec->start_us ? "time_us" : "start_us",
+				      rec->time_us);
+		else if (rec->start_us)
+			export_printf(&exp, ",,%lu,\n", rec->time_us);
+		else
+			export_printf(&exp, ",%lu,,\n", rec->time_us);
+		sep = ",";
+	}
+
+	if (json)
+		export_printf(&exp, "\n],\n\"spans\": [");
+	for (i = 0, sep = ""; i < data->span_count; i++) {
+		const struct bootstage_span *span = &data->span[i];
+		const char *type = span_type_name[span->type];
+
+		if (json)
+			export_printf(&exp, "%s\n{\"type\": \"%s\", \"id\": %d, \"parent\": %d, \"name\": ",
+				      sep, type, i, span->parent);
+		else
+			export_printf(&exp, "%s,%d,%d,", type, i, span->parent);
+		export_str(&exp, span->name);
+		export_printf(&exp, json ?
+			      ", \"start_us\": %u, \"time_us\": %u, \"count\": %u}" :
+			      ",%u,%u,%u\n", span->start_us, get_span_time(span),
+			      span->count);
+		sep = ",";
+	}
+	if (json)
+		export_printf(&exp, "\n]");
+
+	if (CONFIG_IS_ENABLED(PERF_COUNTERS))
+		export_counters(&exp);
+	if (json)
+		export_printf(&exp, "}\n");
+
+	if (buf && exp.len >= size)
+		return -ENOSPC;
+
+	return exp.len;
 }
 
 /**
@@ -526,6 +821,7 @@ int bootstage_init(bool first)
 		return -ENOMEM;
 	data = gd->bootstage;
 	memset(data, '\0', size);
+	data->cur_span = -1;
 	if (first) {
 		data->next_id = BOOTSTAGE_ID_USER;
 		bootstage_add_record(BOOTSTAGE_ID_AWAKE, "reset", 0, 0);
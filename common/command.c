@@ -119,10 +119,55 @@ struct cmd_tbl *find_cmd_tbl(const char *cmd, struct cmd_tbl *table,
 	return NULL;	/* not found or ambiguous command */
 }
 
+/*
+ * The linker sorts the command list by entry name, which is the same as the
+ * command name, so look for an exact match with a binary search. Anything
+ * else (abbreviations, unknown commands) uses the linear search in
+ * find_cmd_tbl(), so a misplaced entry only makes the lookup slower.
+ */
+static struct cmd_tbl *find_cmd_sorted(const char *cmd, struct cmd_tbl *table,
+				       int table_len)
+{
+#ifdef CONFIG_CMDLINE
+	int lo = 0, hi = table_len;
+	const char *p;
+	int len;
+
+	if (!cmd)
+		return NULL;
+	len = ((p = strchr(cmd, '.')) == NULL) ? strlen(cmd) : (p - cmd);
+
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+		const char *name = table[mid].name;
+		int ret;
+
+		ret = strncmp(cmd, name, len);
+		if (!ret) {
+			if (!name[len])
+				return &table[mid];	/* full match */
+			ret = -1;	/* cmd is a prefix of this name */
+		}
+		if (ret < 0)
+			hi = mid;
+		else
+			lo = mid + 1;
+	}
+#endif /* CONFIG_CMDLINE */
+
+	return NULL;
+}
+
 struct cmd_tbl *find_cmd(const char *cmd)
 {
 	struct cmd_tbl *start = ll_entry_start(struct cmd_tbl, cmd);
 	const int len = ll_entry_count(struct cmd_tbl, cmd);
+	struct cmd_tbl *cmdtp;
+
+	cmdtp = find_cmd_sorted(cmd, start, len);
+	if (cmdtp)
+		return cmdtp;
+
 	return find_cmd_tbl(cmd, start, len);
 }
 
@@ -6,6 +6,7 @@
 #endif
 
 #include <malloc.h>
+#include <perf_counter.h>
 #include <asm/io.h>
 
 #ifdef DEBUG
@@ -1303,6 +1304,9 @@ Void_t* mALLOc(bytes) size_t bytes;
 
   if ((long)bytes < 0) return NULL;
 
+  perf_add(PERF_MALLOC, PERF_CNT_READS, 1);
+  perf_add(PERF_MALLOC, PERF_CNT_READ_BYTES, bytes);
+
   nb = request2size(bytes);  /* padded request size; */
 
   /* Check for exact match in a bin */
@@ -1504,7 +1508,10 @@ Void_t* mALLOc(bytes) size_t bytes;
     /* Try to extend */
     malloc_extend_top(nb);
     if ( (remainder_size = chunksize(top) - nb) < (long)MINSIZE)
+    {
+      perf_add(PERF_MALLOC, PERF_CNT_ERRORS, 1);
       return NULL; /* propagate failure */
+    }
   }
 
   victim = top;
@@ -1567,6 +1574,8 @@ void fREe(mem) Void_t* mem;
   if (mem == NULL)                              /* free(0) has no effect */
     return;
 
+  perf_add(PERF_MALLOC, PERF_CNT_WRITES, 1);
+
   p = mem2chunk(mem);
   hd = p->size;
 
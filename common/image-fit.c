@@ -1270,8 +1270,12 @@ int fit_image_verify_with_data(const void *fit, int image_noffset,
 	int		noffset = 0;
 	char		*err_msg = "";
 	int verify_all = 1;
+	int span;
 	int ret;
 
+	span = bootstage_span_begin(BOOTSTAGE_SPAN_VERIFY,
+				    fit_get_name(fit, image_noffset, NULL));
+
 	/* Verify all required signatures */
 	if (FIT_IMAGE_ENABLE_VERIFY &&
 	    fit_image_verify_required_sigs(fit, image_noffset, data, size,
@@ -1318,10 +1322,12 @@ int fit_image_verify_with_data(const void *fit, int image_noffset,
 		err_msg = "Corrupted or truncated tree";
 		goto error;
 	}
+	bootstage_span_end(span);
 
 	return 1;
 
 error:
+	bootstage_span_end(span);
 	printf(" error!\n%s for '%s' hash node in '%s' image node\n",
 	       err_msg, fit_get_name(fit, noffset, NULL),
 	       fit_get_name(fit, image_noffset, NULL));
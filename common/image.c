@@ -8,7 +8,6 @@
 
 #ifndef USE_HOSTCC
 #include <common.h>
-#include <bootstage.h>
 #include <cpu_func.h>
 #include <env.h>
 #include <lmb.h>
@@ -43,6 +42,7 @@
 
 #include <bzlib.h>
 #include <linux/lzo.h>
+#include <linux/zstd.h>
 #include <lzma/LzmaTypes.h>
 #include <lzma/LzmaDec.h>
 #include <lzma/LzmaTools.h>
@@ -69,6 +69,7 @@ static const image_header_t *image_get_ramdisk(ulong rd_addr, uint8_t arch,
 #endif
 #endif /* !USE_HOSTCC*/
 
+#include <bootstage.h>
 #include <u-boot/crc.h>
 #include <imximage.h>
 
@@ -198,6 +199,7 @@ static const table_entry_t uimage_comp[] = {
 	{	IH_COMP_LZMA,	"lzma",		"lzma compressed",	},
 	{	IH_COMP_LZO,	"lzo",		"lzo compressed",	},
 	{	IH_COMP_LZ4,	"lz4",		"lz4 compressed",	},
+	{	IH_COMP_ZSTD,	"zstd",		"zstd compressed",	},
 	{	-1,		"",		"",			},
 };
 
@@ -212,6 +214,7 @@ static const struct comp_magic_map image_comp[] = {
 	{	IH_COMP_GZIP,	"gzip",		{0x1f, 0x8b},},
 	{	IH_COMP_LZMA,	"lzma",		{0x5d, 0x00},},
 	{	IH_COMP_LZO,	"lzo",		{0x89, 0x4c},},
+	{	IH_COMP_ZSTD,	"zstd",		{0x28, 0xb5},},
 	{	IH_COMP_NONE,	"none",		{},	},
 };
 
@@ -440,9 +443,12 @@ int image_decomp(int comp, ulong load, ulong image_start, int type,
 		 uint unc_len, ulong *load_end)
 {
 	int ret = 0;
+	int span;
 
 	*load_end = load;
 	print_decomp_msg(comp, type, load == image_start);
+	span = bootstage_span_begin(BOOTSTAGE_SPAN_DECOMP,
+				    genimg_get_comp_name(comp));
 
 	/*
 	 * Load the image to the right place, decompressing if needed. After
@@ -508,10 +514,49 @@ int image_decomp(int comp, ulong load, ulong image_start, int type,
 		break;
 	}
 #endif /* CONFIG_LZ4 */
+#if CONFIG_IS_ENABLED(ZSTD)
+	case IH_COMP_ZSTD: {
+		ZSTD_DCtx *dctx;
+		void *workspace;
+		size_t wsize, size;
+
+		/*
+		 * Decompress in one shot straight into the load buffer. Unlike
+		 * the streaming API this does not need a window buffer the
+		 * size of the frame's window, so the heap use is small and
+		 * fixed regardless of the compression level used.
+		 */
+		wsize = ZSTD_DCtxWorkspaceBound();
+		workspace = malloc(wsize);
+		if (!workspace) {
+			ret = -ENOMEM;
+			break;
+		}
+		dctx = ZSTD_initDCtx(workspace, wsize);
+		if (!dctx) {
+			free(workspace);
+			ret = -EINVAL;
+			break;
+		}
+		size = ZSTD_decompressDCtx(dctx, load_buf, unc_len, image_buf,
+					   image_len);
+		free(workspace);
+		if (ZSTD_isError(size)) {
+			debug("%s: zstd error %d\n", __func__,
+			      ZSTD_getErrorCode(size));
+			ret = -EINVAL;
+			break;
+		}
+		image_len = size;
+		break;
+	}
+#endif /* CONFIG_ZSTD */
 	default:
 		printf("Unimplemented compression type %d\n", comp);
+		bootstage_span_end(span);
 		return -ENOSYS;
 	}
+	bootstage_span_end(span);
 
 	*load_end = load + image_len;
 
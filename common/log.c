@@ -84,7 +84,7 @@ enum log_level_t log_get_level_by_name(const char *name)
 	return LOGL_NONE;
 }
 
-static struct log_device *log_device_find_by_name(const char *drv_name)
+struct log_device *log_device_find_by_name(const char *drv_name)
 {
 	struct log_device *ldev;
 
@@ -179,18 +179,29 @@ static bool log_passes_filters(struct log_device *ldev, struct log_rec *rec)
  * log_dispatch() - Send a log record to all log devices for processing
  *
  * The log record is sent to each log device in turn, skipping those which have
- * filters which block the record
+ * filters which block the record. The message is only formatted once a device
+ * accepts the record, so records which are filtered out everywhere cost very
+ * little.
  *
- * @rec: Log record to dispatch
+ * @rec: Log record to dispatch (rec->msg is set up by this function)
+ * @fmt: printf() format string for the message
+ * @args: Arguments for @fmt
  * @return 0 (meaning success)
  */
-static int log_dispatch(struct log_rec *rec)
+static int log_dispatch(struct log_rec *rec, const char *fmt, va_list args)
 {
+	char buf[CONFIG_SYS_CBSIZE];
 	struct log_device *ldev;
 
+	rec->msg = NULL;
 	list_for_each_entry(ldev, &gd->log_head, sibling_node) {
-		if (log_passes_filters(ldev, rec))
-			ldev->drv->emit(ldev, rec);
+		if (!log_passes_filters(ldev, rec))
+			continue;
+		if (!rec->msg) {
+			vsnprintf(buf, sizeof(buf), fmt, args);
+			rec->msg = buf;
+		}
+		ldev->drv->emit(ldev, rec);
 	}
 
 	return 0;
@@ -199,25 +210,27 @@ static int log_dispatch(struct log_rec *rec)
 int _log(enum log_category_t cat, enum log_level_t level, const char *file,
 	 int line, const char *func, const char *fmt, ...)
 {
-	char buf[CONFIG_SYS_CBSIZE];
 	struct log_rec rec;
 	va_list args;
 
+	if (!gd || !(gd->flags & GD_FLG_LOG_READY)) {
+		if (gd)
+			gd->log_drop_count++;
+		return -ENOSYS;
+	}
 	rec.cat = cat;
 	rec.level = level;
 	rec.file = file;
 	rec.line = line;
 	rec.func = func;
+	if (CONFIG_IS_ENABLED(LOG_BUF)) {
+		va_start(args, fmt);
+		log_buf_add(&rec, fmt, args);
+		va_end(args);
+	}
 	va_start(args, fmt);
-	vsnprintf(buf, sizeof(buf), fmt, args);
+	log_dispatch(&rec, fmt, args);
 	va_end(args);
-	rec.msg = buf;
-	if (!gd || !(gd->flags & GD_FLG_LOG_READY)) {
-		if (gd)
-			gd->log_drop_count++;
-		return -ENOSYS;
-	}
-	log_dispatch(&rec);
 
 	return 0;
 }
@@ -319,5 +332,10 @@ int log_init(void)
 		gd->default_log_level = CONFIG_LOG_DEFAULT_LEVEL;
 	gd->log_fmt = LOGF_DEFAULT;
 
+	/* The buffer pointer is in BSS, so only set it up once relocated */
+	if (CONFIG_IS_ENABLED(LOG_BUF) && (gd->flags & GD_FLG_RELOC) &&
+	    log_buf_init())
+		debug("%s: Cannot set up log buffer\n", __func__);
+
 	return 0;
 }
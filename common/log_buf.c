@@ -0,0 +1,548 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Binary log buffer
+ *
+ * This keeps the most recent log records with their format string and raw
+ * arguments, so that formatting is only done when the records are shown. It
+ * can be passed to the OS for post-mortem analysis.
+ */
+
+#include <common.h>
+#include <bloblist.h>
+#include <fdt_support.h>
+#include <log.h>
+#include <malloc.h>
+#include <mapmem.h>
+#include <time.h>
+#include <asm/global_data.h>
+#include <linux/ctype.h>
+#include <linux/libfdt.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+enum {
+	LOG_BUF_NAME_MAX	= 47,	/* Longest file/function name stored */
+	LOG_BUF_STR_MAX		= 127,	/* Longest string argument stored */
+	LOG_BUF_DATA_MAX	= 384,	/* Largest data for a record */
+	LOG_BUF_FLAGS_MAX	= 5,	/* Most flag characters in a spec */
+
+	SPEC_NONE		= -1,	/* No width or precision */
+	SPEC_ARG		= -2,	/* Width or precision is an argument */
+};
+
+/* Type of the argument for a conversion in a format string */
+enum arg_type {
+	ARG_NONE,		/* No argument, i.e. '%%' */
+	ARG_INT,
+	ARG_LONG,
+	ARG_LLONG,
+	ARG_SIZE,
+	ARG_PTR,
+	ARG_STR,
+	ARG_UNSUPPORTED,	/* Must be formatted when logged */
+};
+
+/**
+ * struct fmt_spec - a conversion specification in a format string
+ *
+ * @flags: Flag characters, e.g. "-0" (not nul-terminated)
+ * @num_flags: Number of flag characters
+ * @width: Field width, or SPEC_NONE or SPEC_ARG
+ * @prec: Precision, or SPEC_NONE or SPEC_ARG
+ * @len: Length modifier, e.g. "ll"
+ * @conv: Conversion character, e.g. 'x'
+ * @type: Type of the argument
+ */
+struct fmt_spec {
+	const char *flags;
+	int num_flags;
+	int width;
+	int prec;
+	char len[3];
+	char conv;
+	enum arg_type type;
+};
+
+/* This is only set up after relocation, so BSS is fine */
+static struct log_buf_hdr *log_buf;
+
+static const char *parse_num(const char *p, int *valp)
+{
+	if (*p == '*') {
+		*valp = SPEC_ARG;
+		return p + 1;
+	}
+	if (!isdigit(*p)) {
+		*valp = SPEC_NONE;
+		return p;
+	}
+	for (*valp = 0; isdigit(*p); p++)
+		*valp = *valp * 10 + *p - '0';
+
+	return p;
+}
+
+/**
+ * parse_spec() - Parse a conversion specification
+ *
+ * @p: Format string, just after the '%'
+ * @spec: Returns the specification
+ * @return pointer to the format string after the specification
+ */
+static const char *parse_spec(const char *p, struct fmt_spec *spec)
+{
+	int i;
+
+	spec->flags = p;
+	while (*p && strchr("-+ #0", *p))
+		p++;
+	spec->num_flags = p - spec->flags;
+	p = parse_num(p, &spec->width);
+	spec->prec = SPEC_NONE;
+	if (*p == '.') {
+		p = parse_num(p + 1, &spec->prec);
+		if (spec->prec == SPEC_NONE)
+			spec->prec = 0;
+	}
+	for (i = 0; i < 2 && *p && strchr("hlLqtzZ", *p); i++)
+		spec->len[i] = *p++;
+	spec->len[i] = '\0';
+	spec->conv = *p;
+
+	switch (*p) {
+	case '%':
+		spec->type = ARG_NONE;
+		break;
+	case 'c':
+	case 'd':
+	case 'i':
+	case 'o':
+	case 'u':
+	case 'x':
+	case 'X':
+		if (!strcmp(spec->len, "ll") || *spec->len == 'L' ||
+		    *spec->len == 'q')
+			spec->type = ARG_LLONG;
+		else if (*spec->len == 'l' || *spec->len == 't')
+			spec->type = ARG_LONG;
+		else if (*spec->len == 'z' || *spec->len == 'Z')
+			spec->type = ARG_SIZE;
+		else
+			spec->type = ARG_INT;
+		break;
+	case 's':
+		spec->type = ARG_STR;
+		break;
+	case 'p':
+		/* Extensions such as %pM read the data that is pointed to */
+		spec->type = isalnum(p[1]) ? ARG_UNSUPPORTED : ARG_PTR;
+		break;
+	default:
+		spec->type = ARG_UNSUPPORTED;
+		break;
+	}
+
+	return *p ? p + 1 : p;
+}
+
+static u8 *put_arg(u8 *ptr, u8 *end, const void *val, int size)
+{
+	if (!ptr || ptr + size > end)
+		return NULL;
+	memcpy(ptr, val, size);
+
+	return ptr + size;
+}
+
+/**
+ * store_args() - Store the arguments for a format string
+ *
+ * @buf: Buffer to write to
+ * @size: Size of @buf
+ * @fmt: printf() format string
+ * @args: Arguments for @fmt
+ * @return number of bytes written, -ENOSPC if they do not fit, -ENOTSUPP if
+ *	the format string uses a conversion which cannot be deferred
+ */
+static int store_args(u8 *buf, int size, const char *fmt, va_list args)
+{
+	u8 *ptr = buf, *end = buf + size;
+	struct fmt_spec spec;
+	const char *p, *str;
+	int val, len, prec;
+
+	for (p = fmt; *p;) {
+		if (*p++ != '%')
+			continue;
+		p = parse_spec(p, &spec);
+		if (spec.width == SPEC_ARG) {
+			val = va_arg(args, int);
+			ptr = put_arg(ptr, end, &val, sizeof(val));
+		}
+		prec = spec.prec;
+		if (spec.prec == SPEC_ARG) {
+			val = va_arg(args, int);
+			ptr = put_arg(ptr, end, &val, sizeof(val));
+			prec = val;
+		}
+		switch (spec.type) {
+		case ARG_NONE:
+			break;
+		case ARG_INT:
+			val = va_arg(args, int);
+			ptr = put_arg(ptr, end, &val, sizeof(val));
+			break;
+		case ARG_LONG: {
+			long lval = va_arg(args, long);
+
+			ptr = put_arg(ptr, end, &lval, sizeof(lval));
+			break;
+		}
+		case ARG_LLONG: {
+			long long llval = va_arg(args, long long);
+
+			ptr = put_arg(ptr, end, &llval, sizeof(llval));
+			break;
+		}
+		case ARG_SIZE: {
+			size_t sval = va_arg(args, size_t);
+
+			ptr = put_arg(ptr, end, &sval, sizeof(sval));
+			break;
+		}
+		case ARG_PTR: {
+			void *pval = va_arg(args, void *);
+
+			ptr = put_arg(ptr, end, &pval, sizeof(pval));
+			break;
+		}
+		case ARG_STR:
+			str = va_arg(args, const char *);
+			if (!str)
+				str = "(null)";
+			/* The string need not be terminated within the precision */
+			len = LOG_BUF_STR_MAX;
+			if (prec >= 0 && prec < len)
+				len = prec;
+			len = strnlen(str, len);
+			ptr = put_arg(ptr, end, str, len);
+			ptr = put_arg(ptr, end, "", 1);
+			break;
+		case ARG_UNSUPPORTED:
+			return -ENOTSUPP;
+		}
+		if (!ptr)
+			return -ENOSPC;
+	}
+
+	return ptr - buf;
+}
+
+static struct log_buf_rec *rec_at(uint offset)
+{
+	return (void *)(log_buf + 1) + offset;
+}
+
+/* Drop the oldest record to make space */
+static void drop_rec(void)
+{
+	struct log_buf_hdr *hdr = log_buf;
+
+	hdr->tail += rec_at(hdr->tail)->size;
+	hdr->count--;
+	hdr->dropped++;
+	if (!hdr->count)
+		hdr->head = hdr->tail = 0;
+	else if (hdr->tail >= hdr->size || !rec_at(hdr->tail)->size)
+		hdr->tail = 0;
+}
+
+/**
+ * alloc_rec() - Allocate space for a new record, dropping old ones if needed
+ *
+ * @size: Size of the record, a multiple of sizeof(ulong)
+ * @return new record, or NULL if it is too large
+ */
+static struct log_buf_rec *alloc_rec(uint size)
+{
+	struct log_buf_hdr *hdr = log_buf;
+	struct log_buf_rec *rec;
+
+	if (size > hdr->size / 2) {
+		hdr->dropped++;
+		return NULL;
+	}
+	while (hdr->count) {
+		if (hdr->head > hdr->tail) {
+			/* Free space is at the end and the start */
+			if (size <= hdr->size - hdr->head)
+				break;
+			if (hdr->head < hdr->size)
+				rec_at(hdr->head)->size = 0;
+			hdr->head = 0;
+		} else if (size <= hdr->tail - hdr->head) {
+			break;
+		} else {
+			drop_rec();
+		}
+	}
+	rec = rec_at(hdr->head);
+	rec->size = size;
+	hdr->head += size;
+	hdr->count++;
+
+	return rec;
+}
+
+/* Copy a file or function name, keeping the end if it is too long */
+static int put_name(u8 *buf, const char *name)
+{
+	int len;
+
+	if (!name)
+		name = "";
+	len = strlen(name);
+	if (len > LOG_BUF_NAME_MAX) {
+		name += len - LOG_BUF_NAME_MAX;
+		len = LOG_BUF_NAME_MAX;
+	}
+	memcpy(buf, name, len + 1);
+
+	return len + 1;
+}
+
+void log_buf_add(struct log_rec *rec, const char *fmt, va_list args)
+{
+	u8 buf[LOG_BUF_DATA_MAX];
+	struct log_buf_rec *brec;
+	int flags = 0;
+	va_list copy;
+	int pos, len;
+
+	if (!log_buf)
+		return;
+	/* The names are copied since 'log rec' passes them from its args */
+	pos = put_name(buf, rec->file);
+	pos += put_name(buf + pos, rec->func);
+	va_copy(copy, args);
+	len = store_args(buf + pos, sizeof(buf) - pos, fmt, copy);
+	va_end(copy);
+	if (len < 0) {
+		vsnprintf((char *)buf + pos, sizeof(buf) - pos, fmt, args);
+		len = strlen((char *)buf + pos) + 1;
+		flags = LOGBF_TEXT;
+	}
+	pos += len;
+
+	brec = alloc_rec(ALIGN(sizeof(*brec) + pos, sizeof(ulong)));
+	if (!brec)
+		return;
+	brec->level = rec->level;
+	brec->flags = flags;
+	brec->cat = rec->cat;
+	brec->line = rec->line;
+	brec->time_us = timer_get_us();
+	brec->fmt = (ulong)fmt;
+	memcpy(brec + 1, buf, pos);
+}
+
+static int get_int(const u8 **argp)
+{
+	int val;
+
+	memcpy(&val, *argp, sizeof(val));
+	*argp += sizeof(val);
+
+	return val;
+}
+
+/**
+ * format_rec() - Format the message for a record in the log buffer
+ *
+ * Each conversion is formatted separately, with its argument taken from the
+ * record.
+ *
+ * @brec: Record to format
+ * @arg: Arguments for the record
+ * @buf: Buffer to hold the message
+ * @size: Size of @buf
+ * @return message
+ */
+static const char *format_rec(struct log_buf_rec *brec, const u8 *arg,
+			      char *buf, int size)
+{
+	char spec_str[LOG_BUF_FLAGS_MAX + 30];
+	struct fmt_spec spec;
+	int width, prec, n;
+	const char *p;
+	int len = 0;
+
+	if (brec->flags & LOGBF_TEXT)
+		return (const char *)arg;
+
+	for (p = (const char *)brec->fmt; *p && len < size - 1;) {
+		char *out = buf + len;
+		int avail = size - len;
+
+		if (*p != '%') {
+			buf[len++] = *p++;
+			continue;
+		}
+		p = parse_spec(p + 1, &spec);
+		if (spec.type == ARG_NONE) {
+			buf[len++] = '%';
+			continue;
+		}
+
+		/* Rebuild the specification with any '*' values filled in */
+		n = sprintf(spec_str, "%%%.*s",
+			    min(spec.num_flags, (int)LOG_BUF_FLAGS_MAX),
+			    spec.flags);
+		if (spec.width != SPEC_NONE) {
+			width = spec.width == SPEC_ARG ? get_int(&arg) :
+				spec.width;
+			n += sprintf(spec_str + n, "%d", width);
+		}
+		prec = spec.prec == SPEC_ARG ? get_int(&arg) : spec.prec;
+		if (prec >= 0)
+			n += sprintf(spec_str + n, ".%d", prec);
+		sprintf(spec_str + n, "%s%c", spec.len, spec.conv);
+
+		switch (spec.type) {
+		case ARG_INT:
+			len += snprintf(out, avail, spec_str, get_int(&arg));
+			break;
+		case ARG_LONG: {
+			long val;
+
+			memcpy(&val, arg, sizeof(val));
+			arg += sizeof(val);
+			len += snprintf(out, avail, spec_str, val);
+			break;
+		}
+		case ARG_LLONG: {
+			long long val;
+
+			memcpy(&val, arg, sizeof(val));
+			arg += sizeof(val);
+			len += snprintf(out, avail, spec_str, val);
+			break;
+		}
+		case ARG_SIZE: {
+			size_t val;
+
+			memcpy(&val, arg, sizeof(val));
+			arg += sizeof(val);
+			len += snprintf(out, avail, spec_str, val);
+			break;
+		}
+		case ARG_PTR: {
+			void *val;
+
+			memcpy(&val, arg, sizeof(val));
+			arg += sizeof(val);
+			len += snprintf(out, avail, spec_str, val);
+			break;
+		}
+		case ARG_STR:
+			len += snprintf(out, avail, spec_str, (const char *)arg);
+			arg += strlen((const char *)arg) + 1;
+			break;
+		default:
+			break;
+		}
+		len = min(len, size - 1);
+	}
+	buf[len] = '\0';
+
+	return buf;
+}
+
+int log_buf_dump(void)
+{
+	struct log_device *ldev = log_device_find_by_name("console");
+	char msg[CONFIG_SYS_CBSIZE];
+	struct log_rec rec;
+	uint offset;
+	int i;
+
+	if (!log_buf)
+		return -ENOENT;
+	if (log_buf->dropped)
+		printf("(%u older records dropped)\n", log_buf->dropped);
+
+	offset = log_buf->tail;
+	for (i = 0; i < log_buf->count; i++) {
+		struct log_buf_rec *brec;
+
+		if (offset >= log_buf->size || !rec_at(offset)->size)
+			offset = 0;
+		brec = rec_at(offset);
+		offset += brec->size;
+
+		rec.cat = brec->cat;
+		rec.level = brec->level;
+		rec.file = (const char *)(brec + 1);
+		rec.line = brec->line;
+		rec.func = rec.file + strlen(rec.file) + 1;
+		rec.msg = format_rec(brec,
+				     (const u8 *)rec.func + strlen(rec.func) + 1,
+				     msg, sizeof(msg));
+		printf("%5u.%06u ", brec->time_us / 1000000,
+		       brec->time_us % 1000000);
+		if (ldev)
+			ldev->drv->emit(ldev, &rec);
+		else
+			printf("%s", rec.msg);
+	}
+
+	return 0;
+}
+
+int log_buf_fdt_fixup(void *blob)
+{
+	fdt64_t val[2];
+	ulong addr, size;
+	int node, ret;
+
+	if (!log_buf)
+		return 0;
+	addr = map_to_sysmem(log_buf);
+	size = sizeof(*log_buf) + log_buf->size;
+	ret = fdt_add_mem_rsv(blob, addr, size);
+	if (ret)
+		return ret;
+	node = fdt_find_or_add_subnode(blob, 0, "chosen");
+	if (node < 0)
+		return node;
+	val[0] = cpu_to_fdt64(addr);
+	val[1] = cpu_to_fdt64(size);
+
+	return fdt_setprop(blob, node, "u-boot,log-buf", val, sizeof(val));
+}
+
+int log_buf_init(void)
+{
+	struct log_buf_hdr *hdr = NULL;
+	int size = CONFIG_LOG_BUF_SIZE;
+
+	if (CONFIG_IS_ENABLED(BLOBLIST)) {
+		hdr = bloblist_ensure(BLOBLISTT_LOG_BUF, size);
+		if (!hdr)
+			printf("Log buffer: no room in bloblist, using heap\n");
+	}
+	if (!hdr)
+		hdr = malloc(size);
+	if (!hdr)
+		return -ENOMEM;
+
+	memset(hdr, '\0', sizeof(*hdr));
+	hdr->magic = LOG_BUF_MAGIC;
+	hdr->version = LOG_BUF_VERSION;
+	hdr->ptr_size = sizeof(ulong);
+	hdr->size = ALIGN_DOWN(size - sizeof(*hdr), sizeof(ulong));
+	hdr->reloc_off = gd->reloc_off;
+	log_buf = hdr;
+
+	return 0;
+}
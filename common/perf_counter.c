@@ -0,0 +1,134 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Hot-path performance counters
+ */
+
+#include <common.h>
+#include <perf_counter.h>
+#include <time.h>
+#include <vsprintf.h>
+#include <asm/global_data.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+enum {
+	PERF_DIGITS = 12,
+};
+
+static const char *const subsys_name[PERF_SUBSYS_COUNT] = {
+	[PERF_BLK]	= "blk",
+	[PERF_ETH]	= "eth",
+	[PERF_MTD]	= "mtd",
+	[PERF_MALLOC]	= "malloc",
+};
+
+static const char *const counter_name[PERF_SUBSYS_COUNT][PERF_CNT_COUNT] = {
+	[PERF_BLK] = {
+		[PERF_CNT_READS]	= "reads",
+		[PERF_CNT_READ_BYTES]	= "read_bytes",
+		[PERF_CNT_WRITES]	= "writes",
+		[PERF_CNT_WRITE_BYTES]	= "write_bytes",
+		[PERF_CNT_ERASES]	= "erases",
+		[PERF_CNT_TIME_US]	= "time_us",
+		[PERF_CNT_CACHE_HITS]	= "cache_hits",
+		[PERF_CNT_ERRORS]	= "errors",
+	},
+	[PERF_ETH] = {
+		[PERF_CNT_READS]	= "rx_packets",
+		[PERF_CNT_READ_BYTES]	= "rx_bytes",
+		[PERF_CNT_WRITES]	= "tx_packets",
+		[PERF_CNT_WRITE_BYTES]	= "tx_bytes",
+		[PERF_CNT_TIME_US]	= "time_us",
+		[PERF_CNT_ERRORS]	= "errors",
+	},
+	[PERF_MTD] = {
+		[PERF_CNT_READS]	= "reads",
+		[PERF_CNT_READ_BYTES]	= "read_bytes",
+		[PERF_CNT_WRITES]	= "writes",
+		[PERF_CNT_WRITE_BYTES]	= "write_bytes",
+		[PERF_CNT_ERASES]	= "erases",
+		[PERF_CNT_TIME_US]	= "time_us",
+		[PERF_CNT_ERRORS]	= "errors",
+	},
+	[PERF_MALLOC] = {
+		[PERF_CNT_READS]	= "allocs",
+		[PERF_CNT_READ_BYTES]	= "alloc_bytes",
+		[PERF_CNT_WRITES]	= "frees",
+		[PERF_CNT_ERRORS]	= "failures",
+	},
+};
+
+/*
+ * This is in BSS so costs nothing in the image, but it cannot be written
+ * until relocation
+ */
+static u64 counter[PERF_SUBSYS_COUNT][PERF_CNT_COUNT];
+
+void perf_add(enum perf_subsys sys, enum perf_counter cnt, ulong val)
+{
+	if (gd->flags & GD_FLG_RELOC)
+		counter[sys][cnt] += val;
+}
+
+ulong perf_time_start(void)
+{
+	return timer_get_us();
+}
+
+void perf_time_end(enum perf_subsys sys, ulong start)
+{
+	perf_add(sys, PERF_CNT_TIME_US, timer_get_us() - start);
+}
+
+u64 perf_get(enum perf_subsys sys, enum perf_counter cnt)
+{
+	return counter[sys][cnt];
+}
+
+const char *perf_get_subsys_name(enum perf_subsys sys)
+{
+	return subsys_name[sys];
+}
+
+const char *perf_get_counter_name(enum perf_subsys sys,
+				  enum perf_counter cnt)
+{
+	return counter_name[sys][cnt];
+}
+
+static bool subsys_used(enum perf_subsys sys)
+{
+	int cnt;
+
+	for (cnt = 0; cnt < PERF_CNT_COUNT; cnt++) {
+		if (counter[sys][cnt])
+			return true;
+	}
+
+	return false;
+}
+
+void perf_show(void)
+{
+	int sys, cnt;
+
+	printf("%-8s%-13s%15s\n", "Subsys", "Counter", "Value");
+	for (sys = 0; sys < PERF_SUBSYS_COUNT; sys++) {
+		if (!subsys_used(sys))
+			continue;
+		for (cnt = 0; cnt < PERF_CNT_COUNT; cnt++) {
+			const char *name = counter_name[sys][cnt];
+
+			if (!name)
+				continue;
+			printf("%-8s%-13s", subsys_name[sys], name);
+			print_grouped_ull(counter[sys][cnt], PERF_DIGITS);
+			printf("\n");
+		}
+	}
+}
+
+void perf_reset(void)
+{
+	memset(counter, '\0', sizeof(counter));
+}
@@ -327,8 +327,17 @@ static int spl_load_fit_image(struct spl_load_info *info, ulong sector,
 			return -EIO;
 		}
 		length = size;
-	} else {
-		memcpy((void *)load_addr, src, length);
+	} else if ((ulong)src != load_addr) {
+		/*
+		 * External data is read to an aligned buffer at or just above
+		 * the load address, so the regions may overlap. When the image
+		 * data and the load address are suitably aligned, the data is
+		 * read straight to its final place and this is not reached.
+		 * Embedded data is copied out of the FIT, which may also
+		 * overlap the load address. It is only in place already if
+		 * the load address is that of the data within the FIT.
+		 */
+		memmove((void *)load_addr, src, length);
 	}
 
 	if (image_info) {
@@ -958,8 +958,11 @@ static void usb_stor_set_max_xfer_blk(struct usb_device *udev,
 	 * Windows 7 limiting transfers to 128 sectors for both USB2 and USB3
 	 * and Apple Mac OS X 10.11 limiting transfers to 256 sectors for USB2
 	 * and 2048 for USB3 devices.
+	 *
+	 * Follow the latter for SuperSpeed devices, where the per-command
+	 * overhead otherwise dominates the transfer time.
 	 */
-	unsigned short blk = 240;
+	unsigned short blk = udev->speed >= USB_SPEED_SUPER ? 2048 : 240;
 
 #if CONFIG_IS_ENABLED(DM_USB)
 	size_t size;
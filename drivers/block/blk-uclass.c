@@ -6,10 +6,12 @@
 
 #include <common.h>
 #include <blk.h>
+#include <bootstage.h>
 #include <dm.h>
 #include <log.h>
 #include <malloc.h>
 #include <part.h>
+#include <perf_counter.h>
 #include <dm/device-internal.h>
 #include <dm/lists.h>
 #include <dm/uclass-internal.h>
@@ -435,18 +437,33 @@ unsigned long blk_dread(struct blk_desc *block_dev, lbaint_t start,
 {
 	struct udevice *dev = block_dev->bdev;
 	const struct blk_ops *ops = blk_get_ops(dev);
-	ulong blks_read;
+	ulong blks_read, perf_start;
+	int span;
 
 	if (!ops->read)
 		return -ENOSYS;
 
+	perf_add(PERF_BLK, PERF_CNT_READS, 1);
 	if (blkcache_read(block_dev->if_type, block_dev->devnum,
-			  start, blkcnt, block_dev->blksz, buffer))
+			  start, blkcnt, block_dev->blksz, buffer)) {
+		perf_add(PERF_BLK, PERF_CNT_CACHE_HITS, 1);
+		perf_add(PERF_BLK, PERF_CNT_READ_BYTES,
+			 blkcnt * block_dev->blksz);
 		return blkcnt;
+	}
+	span = bootstage_span_begin(BOOTSTAGE_SPAN_READ, dev->name);
+	perf_start = perf_time_start();
 	blks_read = ops->read(dev, start, blkcnt, buffer);
+	perf_time_end(PERF_BLK, perf_start);
+	bootstage_span_end(span);
 	if (blks_read == blkcnt)
 		blkcache_fill(block_dev->if_type, block_dev->devnum,
 			      start, blkcnt, block_dev->blksz, buffer);
+	if (IS_ERR_VALUE(blks_read))
+		perf_add(PERF_BLK, PERF_CNT_ERRORS, 1);
+	else
+		perf_add(PERF_BLK, PERF_CNT_READ_BYTES,
+			 blks_read * block_dev->blksz);
 
 	return blks_read;
 }
@@ -456,12 +473,23 @@ unsigned long blk_dwrite(struct blk_desc *block_dev, lbaint_t start,
 {
 	struct udevice *dev = block_dev->bdev;
 	const struct blk_ops *ops = blk_get_ops(dev);
+	ulong blks_written, perf_start;
 
 	if (!ops->write)
 		return -ENOSYS;
 
 	blkcache_invalidate(block_dev->if_type, block_dev->devnum);
-	return ops->write(dev, start, blkcnt, buffer);
+	perf_add(PERF_BLK, PERF_CNT_WRITES, 1);
+	perf_start = perf_time_start();
+	blks_written = ops->write(dev, start, blkcnt, buffer);
+	perf_time_end(PERF_BLK, perf_start);
+	if (IS_ERR_VALUE(blks_written))
+		perf_add(PERF_BLK, PERF_CNT_ERRORS, 1);
+	else
+		perf_add(PERF_BLK, PERF_CNT_WRITE_BYTES,
+			 blks_written * block_dev->blksz);
+
+	return blks_written;
 }
 
 unsigned long blk_derase(struct blk_desc *block_dev, lbaint_t start,
@@ -469,12 +497,20 @@ unsigned long blk_derase(struct blk_desc *block_dev, lbaint_t start,
 {
 	struct udevice *dev = block_dev->bdev;
 	const struct blk_ops *ops = blk_get_ops(dev);
+	ulong blks_erased, perf_start;
 
 	if (!ops->erase)
 		return -ENOSYS;
 
 	blkcache_invalidate(block_dev->if_type, block_dev->devnum);
-	return ops->erase(dev, start, blkcnt);
+	perf_add(PERF_BLK, PERF_CNT_ERASES, 1);
+	perf_start = perf_time_start();
+	blks_erased = ops->erase(dev, start, blkcnt);
+	perf_time_end(PERF_BLK, perf_start);
+	if (IS_ERR_VALUE(blks_erased))
+		perf_add(PERF_BLK, PERF_CNT_ERRORS, 1);
+
+	return blks_erased;
 }
 
 int blk_get_from_parent(struct udevice *parent, struct udevice **devp)
@@ -9,6 +9,7 @@
  */
 
 #include <common.h>
+#include <bootstage.h>
 #include <cpu_func.h>
 #include <log.h>
 #include <asm/io.h>
@@ -396,6 +397,7 @@ fail:
 int device_probe(struct udevice *dev)
 {
 	const struct driver *drv;
+	int span;
 	int ret;
 	int seq;
 
@@ -408,6 +410,8 @@ int device_probe(struct udevice *dev)
 	drv = dev->driver;
 	assert(drv);
 
+	span = bootstage_span_begin(BOOTSTAGE_SPAN_PROBE, dev->name);
+
 	ret = device_ofdata_to_platdata(dev);
 	if (ret)
 		goto fail;
@@ -424,8 +428,10 @@ int device_probe(struct udevice *dev)
 		 * (e.g. PCI bridge devices). Test the flags again
 		 * so that we don't mess up the device.
 		 */
-		if (dev->flags & DM_FLAG_ACTIVATED)
+		if (dev->flags & DM_FLAG_ACTIVATED) {
+			bootstage_span_end(span);
 			return 0;
+		}
 	}
 
 	seq = uclass_resolve_seq(dev);
@@ -487,6 +493,7 @@ int device_probe(struct udevice *dev)
 
 	if (dev->parent && device_get_uclass_id(dev) == UCLASS_PINCTRL)
 		pinctrl_select_state(dev, "default");
+	bootstage_span_end(span);
 
 	return 0;
 fail_uclass:
@@ -499,6 +506,7 @@ fail:
 
 	dev->seq = -1;
 	device_free(dev);
+	bootstage_span_end(span);
 
 	return ret;
 }
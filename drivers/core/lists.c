@@ -18,8 +18,13 @@
 #include <dm/uclass.h>
 #include <dm/util.h>
 #include <fdtdec.h>
+#include <malloc.h>
+#include <sort.h>
+#include <asm/global_data.h>
 #include <linux/compiler.h>
 
+DECLARE_GLOBAL_DATA_PTR;
+
 struct driver *lists_driver_lookup_name(const char *name)
 {
 	struct driver *drv =
@@ -125,11 +130,165 @@ static int driver_check_compatible(const struct udevice_id *of_match,
 	return -ENOENT;
 }
 
-int lists_bind_fdt(struct udevice *parent, ofnode node, struct udevice **devp,
-		   bool pre_reloc_only)
+#if CONFIG_IS_ENABLED(DM_COMPAT_INDEX)
+/**
+ * struct compat_entry - an entry in the compatible-string index
+ *
+ * @compat:	Compatible string
+ * @drv:	First driver in the linker list which matches @compat
+ * @id:		Entry in @drv's of_match table which matches @compat
+ */
+struct compat_entry {
+	const char *compat;
+	struct driver *drv;
+	const struct udevice_id *id;
+};
+
+/*
+ * The index is sorted by compatible string, for a binary search. It is built
+ * on first use after relocation, since BSS cannot be written before that
+ */
+static struct compat_entry *compat_index;
+static int compat_index_count;
+static bool compat_index_done;
+
+static int compat_entry_cmp(const void *v1, const void *v2)
+{
+	const struct compat_entry *e1 = v1, *e2 = v2;
+	int ret;
+
+	ret = strcmp(e1->compat, e2->compat);
+	if (ret)
+		return ret;
+
+	/* Keep linker-list order for drivers with the same compatible string */
+	if (e1->drv != e2->drv)
+		return e1->drv < e2->drv ? -1 : 1;
+	if (e1->id != e2->id)
+		return e1->id < e2->id ? -1 : 1;
+
+	return 0;
+}
+
+/**
+ * compat_index_build() - Build the compatible-string index
+ *
+ * If there is not enough memory, the index is left empty and callers fall
+ * back to a linear search of the driver list
+ *
+ * @return 0 if OK, -ENOMEM if out of memory
+ */
+static int compat_index_build(void)
 {
 	struct driver *driver = ll_entry_start(struct driver, driver);
 	const int n_ents = ll_entry_count(struct driver, driver);
+	const struct udevice_id *id;
+	struct compat_entry *index, *ptr;
+	struct driver *entry;
+	int count = 0;
+	int i;
+
+	compat_index_done = true;
+	for (entry = driver; entry != driver + n_ents; entry++) {
+		for (id = entry->of_match; id && id->compatible; id++)
+			count++;
+	}
+	if (!count)
+		return 0;
+
+	index = malloc(count * sizeof(*index));
+	if (!index)
+		return log_msg_ret("index", -ENOMEM);
+	ptr = index;
+	for (entry = driver; entry != driver + n_ents; entry++) {
+		for (id = entry->of_match; id && id->compatible; id++) {
+			ptr->compat = id->compatible;
+			ptr->drv = entry;
+			ptr->id = id;
+			ptr++;
+		}
+	}
+	qsort(index, count, sizeof(*index), compat_entry_cmp);
+
+	/* Only the first driver for each string is ever used, so drop the rest */
+	ptr = index;
+	for (i = 1; i < count; i++) {
+		if (strcmp(index[i].compat, ptr->compat))
+			*++ptr = index[i];
+	}
+	compat_index = index;
+	compat_index_count = ptr - index + 1;
+	log_debug("Compatible-string index has %d entries\n",
+		  compat_index_count);
+
+	return 0;
+}
+
+/**
+ * compat_index_lookup() - Look up a compatible string in the index
+ *
+ * @compat:	The compatible string to search for
+ * @of_idp:	Returns the match that was found
+ * @return driver which matches, or NULL if none
+ */
+static struct driver *compat_index_lookup(const char *compat,
+					  const struct udevice_id **of_idp)
+{
+	int lo = 0, hi = compat_index_count;
+
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+		struct compat_entry *entry = &compat_index[mid];
+		int ret = strcmp(compat, entry->compat);
+
+		if (!ret) {
+			*of_idp = entry->id;
+			return entry->drv;
+		}
+		if (ret < 0)
+			hi = mid;
+		else
+			lo = mid + 1;
+	}
+
+	return NULL;
+}
+#endif
+
+/**
+ * driver_find_compatible() - Find the first driver with a compatible string
+ *
+ * This uses the compatible-string index if available, otherwise it checks
+ * each driver in turn
+ *
+ * @compat:	The compatible string to search for
+ * @of_idp:	Returns the match that was found
+ * @return driver which matches, or NULL if none
+ */
+static struct driver *driver_find_compatible(const char *compat,
+					     const struct udevice_id **of_idp)
+{
+	struct driver *driver = ll_entry_start(struct driver, driver);
+	const int n_ents = ll_entry_count(struct driver, driver);
+	struct driver *entry;
+
+#if CONFIG_IS_ENABLED(DM_COMPAT_INDEX)
+	if (!compat_index_done && (gd->flags & GD_FLG_RELOC))
+		compat_index_build();
+	if (compat_index)
+		return compat_index_lookup(compat, of_idp);
+#endif
+	for (entry = driver; entry != driver + n_ents; entry++) {
+		if (!driver_check_compatible(entry->of_match, of_idp, compat))
+			return entry;
+	}
+
+	return NULL;
+}
+
+int lists_bind_fdt(struct udevice *parent, ofnode node, struct udevice **devp,
+		   bool pre_reloc_only)
+{
 	const struct udevice_id *id;
 	struct driver *entry;
 	struct udevice *dev;
@@ -166,14 +325,11 @@ int lists_bind_fdt(struct udevice *parent, ofnode node, struct udevice **devp,
 		log_debug("   - attempt to match compatible string '%s'\n",
 			  compat);
 
-		for (entry = driver; entry != driver + n_ents; entry++) {
-			ret = driver_check_compatible(entry->of_match, &id,
-						      compat);
-			if (!ret)
-				break;
-		}
-		if (entry == driver + n_ents)
+		entry = driver_find_compatible(compat, &id);
+		if (!entry) {
+			ret = -ENOENT;
 			continue;
+		}
 
 		if (pre_reloc_only) {
 			if (!ofnode_pre_reloc(node) &&
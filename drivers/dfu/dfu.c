@@ -238,10 +238,6 @@ static int dfu_write_buffer_drain(struct dfu_entity *dfu)
 	if (w_size == 0)
 		return 0;
 
-	if (dfu_hash_algo)
-		dfu_hash_algo->hash_update(dfu_hash_algo, &dfu->crc,
-					   dfu->i_buf_start, w_size, 0);
-
 	ret = dfu->write_medium(dfu, dfu->offset, dfu->i_buf_start, &w_size);
 	if (ret)
 		debug("%s: Write error!\n", __func__);
@@ -377,6 +373,14 @@ int dfu_write(struct dfu_entity *dfu, void *buf, int size, int blk_seq_num)
 	memcpy(dfu->i_buf, buf, size);
 	dfu->i_buf += size;
 
+	/*
+	 * Hash each chunk as it arrives, while it is still hot in the cache,
+	 * rather than walking the whole buffer again when it is drained.
+	 */
+	if (dfu_hash_algo && size)
+		dfu_hash_algo->hash_update(dfu_hash_algo, &dfu->crc, buf,
+					   size, 0);
+
 	/* if end or if buffer full flush */
 	if (size == 0 || (dfu->i_buf + size) > dfu->i_buf_end) {
 		ret = dfu_write_buffer_drain(dfu);
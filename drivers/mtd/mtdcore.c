@@ -31,6 +31,7 @@
 #include <linux/bitops.h>
 #include <linux/bug.h>
 #include <linux/err.h>
+#include <perf_counter.h>
 #include <ubi_uboot.h>
 #endif
 
@@ -882,6 +883,9 @@ EXPORT_SYMBOL_GPL(__put_mtd_device);
  */
 int mtd_erase(struct mtd_info *mtd, struct erase_info *instr)
 {
+	ulong perf_start;
+	int ret;
+
 	if (instr->addr > mtd->size || instr->len > mtd->size - instr->addr)
 		return -EINVAL;
 	if (!(mtd->flags & MTD_WRITEABLE))
@@ -892,7 +896,14 @@ int mtd_erase(struct mtd_info *mtd, struct erase_info *instr)
 		mtd_erase_callback(instr);
 		return 0;
 	}
-	return mtd->_erase(mtd, instr);
+	perf_add(PERF_MTD, PERF_CNT_ERASES, 1);
+	perf_start = perf_time_start();
+	ret = mtd->_erase(mtd, instr);
+	perf_time_end(PERF_MTD, perf_start);
+	if (ret)
+		perf_add(PERF_MTD, PERF_CNT_ERRORS, 1);
+
+	return ret;
 }
 EXPORT_SYMBOL_GPL(mtd_erase);
 
@@ -950,6 +961,7 @@ EXPORT_SYMBOL_GPL(mtd_get_unmapped_area);
 int mtd_read(struct mtd_info *mtd, loff_t from, size_t len, size_t *retlen,
 	     u_char *buf)
 {
+	ulong perf_start;
 	int ret_code;
 	*retlen = 0;
 	if (from < 0 || from > mtd->size || len > mtd->size - from)
@@ -962,6 +974,7 @@ int mtd_read(struct mtd_info *mtd, loff_t from, size_t len, size_t *retlen,
 	 * representing the maximum number of bitflips that were corrected on
 	 * any one ecc region (if applicable; zero otherwise).
 	 */
+	perf_start = perf_time_start();
 	if (mtd->_read) {
 		ret_code = mtd->_read(mtd, from, len, retlen, buf);
 	} else if (mtd->_read_oob) {
@@ -975,9 +988,14 @@ int mtd_read(struct mtd_info *mtd, loff_t from, size_t len, size_t *retlen,
 	} else {
 		return -ENOTSUPP;
 	}
+	perf_time_end(PERF_MTD, perf_start);
+	perf_add(PERF_MTD, PERF_CNT_READS, 1);
+	perf_add(PERF_MTD, PERF_CNT_READ_BYTES, *retlen);
 
-	if (unlikely(ret_code < 0))
+	if (unlikely(ret_code < 0)) {
+		perf_add(PERF_MTD, PERF_CNT_ERRORS, 1);
 		return ret_code;
+	}
 	if (mtd->ecc_strength == 0)
 		return 0;	/* device lacks ecc */
 	return ret_code >= mtd->bitflip_threshold ? -EUCLEAN : 0;
@@ -987,6 +1005,9 @@ EXPORT_SYMBOL_GPL(mtd_read);
 int mtd_write(struct mtd_info *mtd, loff_t to, size_t len, size_t *retlen,
 	      const u_char *buf)
 {
+	ulong perf_start;
+	int ret;
+
 	*retlen = 0;
 	if (to < 0 || to > mtd->size || len > mtd->size - to)
 		return -EINVAL;
@@ -996,19 +1017,25 @@ int mtd_write(struct mtd_info *mtd, loff_t to, size_t len, size_t *retlen,
 	if (!len)
 		return 0;
 
+	perf_start = perf_time_start();
 	if (!mtd->_write) {
 		struct mtd_oob_ops ops = {
 			.len = len,
 			.datbuf = (u8 *)buf,
 		};
-		int ret;
 
 		ret = mtd->_write_oob(mtd, to, &ops);
 		*retlen = ops.retlen;
-		return ret;
+	} else {
+		ret = mtd->_write(mtd, to, len, retlen, buf);
 	}
+	perf_time_end(PERF_MTD, perf_start);
+	perf_add(PERF_MTD, PERF_CNT_WRITES, 1);
+	perf_add(PERF_MTD, PERF_CNT_WRITE_BYTES, *retlen);
+	if (ret)
+		perf_add(PERF_MTD, PERF_CNT_ERRORS, 1);
 
-	return mtd->_write(mtd, to, len, retlen, buf);
+	return ret;
 }
 EXPORT_SYMBOL_GPL(mtd_write);
 
@@ -78,6 +78,7 @@
 #include <linux/random.h>
 #include <u-boot/crc.h>
 #else
+#include <bootstage.h>
 #include <div64.h>
 #include <linux/bug.h>
 #include <linux/err.h>
@@ -819,7 +820,7 @@ static int scan_peb(struct ubi_device *ubi, struct ubi_attach_info *ai,
 		    int pnum, int *vid, unsigned long long *sqnum)
 {
 	long long uninitialized_var(ec);
-	int err, bitflips = 0, vol_id = -1, ec_err = 0;
+	int err, bitflips = 0, vol_id = -1, ec_err = 0, vid_err = 0;
 
 	dbg_bld("scan PEB %d", pnum);
 
@@ -832,7 +833,10 @@ static int scan_peb(struct ubi_device *ubi, struct ubi_attach_info *ai,
 		return 0;
 	}
 
-	err = ubi_io_read_ec_hdr(ubi, pnum, ech, 0);
+	if (ubi->hdrs_read_size)
+		err = ubi_io_read_hdrs(ubi, pnum, ech, vidh, &vid_err);
+	else
+		err = ubi_io_read_ec_hdr(ubi, pnum, ech, 0);
 	if (err < 0)
 		return err;
 	switch (err) {
@@ -915,7 +919,10 @@ static int scan_peb(struct ubi_device *ubi, struct ubi_attach_info *ai,
 
 	/* OK, we've done with the EC header, let's look at the VID header */
 
-	err = ubi_io_read_vid_hdr(ubi, pnum, vidh, 0);
+	if (ubi->hdrs_read_size)
+		err = vid_err;
+	else
+		err = ubi_io_read_vid_hdr(ubi, pnum, vidh, 0);
 	if (err < 0)
 		return err;
 	switch (err) {
@@ -1230,10 +1237,11 @@ static int scan_all(struct ubi_device *ubi, struct ubi_attach_info *ai,
 	struct rb_node *rb1, *rb2;
 	struct ubi_ainf_volume *av;
 	struct ubi_ainf_peb *aeb;
+	unsigned long tstart = get_timer(0);
 
 	err = -ENOMEM;
 
-	ech = kzalloc(ubi->ec_hdr_alsize, GFP_KERNEL);
+	ech = kzalloc(max(ubi->ec_hdr_alsize, ubi->hdrs_read_size), GFP_KERNEL);
 	if (!ech)
 		return err;
 
@@ -1250,7 +1258,7 @@ static int scan_all(struct ubi_device *ubi, struct ubi_attach_info *ai,
 			goto out_vidh;
 	}
 
-	ubi_msg(ubi, "scanning is finished");
+	ubi_msg(ubi, "scanning is finished in %lu ms", get_timer(tstart));
 
 	/* Calculate mean erase counter */
 	if (ai->ec_count)
@@ -1342,7 +1350,7 @@ static int scan_fast(struct ubi_device *ubi, struct ubi_attach_info **ai)
 
 	err = -ENOMEM;
 
-	ech = kzalloc(ubi->ec_hdr_alsize, GFP_KERNEL);
+	ech = kzalloc(max(ubi->ec_hdr_alsize, ubi->hdrs_read_size), GFP_KERNEL);
 	if (!ech)
 		goto out;
 
@@ -1406,6 +1414,8 @@ int ubi_attach(struct ubi_device *ubi, int force_scan)
 	if (!ai)
 		return -ENOMEM;
 
+	bootstage_start(BOOTSTAGE_ID_ACCUM_UBI, "ubi_attach");
+
 #ifdef CONFIG_MTD_UBI_FASTMAP
 	/* On small flash devices we disable fastmap in any case. */
 	if ((int)mtd_div_by_eb(ubi->mtd->size, ubi->mtd) <= UBI_FM_MAX_START) {
@@ -1421,10 +1431,19 @@ int ubi_attach(struct ubi_device *ubi, int force_scan)
 			if (err != UBI_NO_FASTMAP) {
 				destroy_ai(ai);
 				ai = alloc_ai();
-				if (!ai)
+				if (!ai) {
+					bootstage_accum(BOOTSTAGE_ID_ACCUM_UBI);
 					return -ENOMEM;
+				}
 
 				err = scan_all(ubi, ai, 0);
+
+				/*
+				 * The image uses fastmap, but the one on flash
+				 * is invalid. Enable writing a new one.
+				 */
+				if (IS_ENABLED(CONFIG_MTD_UBI_FASTMAP_KEEP))
+					ubi->fm_disabled = 0;
 			} else {
 				err = scan_all(ubi, ai, UBI_FM_MAX_START);
 			}
@@ -1480,6 +1499,7 @@ int ubi_attach(struct ubi_device *ubi, int force_scan)
 #endif
 
 	destroy_ai(ai);
+	bootstage_accum(BOOTSTAGE_ID_ACCUM_UBI);
 	return 0;
 
 out_wl:
@@ -1489,6 +1509,7 @@ out_vtbl:
 	vfree(ubi->vtbl);
 out_ai:
 	destroy_ai(ai);
+	bootstage_accum(BOOTSTAGE_ID_ACCUM_UBI);
 	return err;
 }
 
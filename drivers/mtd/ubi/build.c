@@ -750,6 +750,12 @@ static int io_init(struct ubi_device *ubi, int max_beb_per1024)
 	dbg_gen("vid_hdr_shift    %d", ubi->vid_hdr_shift);
 	dbg_gen("leb_start        %d", ubi->leb_start);
 
+	/* Scanning reads both headers at once if they share a NAND page */
+	if (ubi->vid_hdr_aloffset + ubi->vid_hdr_alsize <= ubi->mtd->writesize)
+		ubi->hdrs_read_size = ubi->vid_hdr_aloffset +
+				      ubi->vid_hdr_alsize;
+	dbg_gen("hdrs_read_size   %d", ubi->hdrs_read_size);
+
 	/* The shift must be aligned to 32-bit boundary */
 	if (ubi->vid_hdr_shift % 4) {
 		ubi_err(ubi, "unaligned VID header shift %d",
@@ -1017,6 +1023,18 @@ int ubi_attach_mtd_dev(struct mtd_info *mtd, int ubi_num,
 			goto out_detach;
 	}
 
+#ifdef CONFIG_MTD_UBI_FASTMAP_KEEP
+	/*
+	 * Fastmap is enabled but attaching had to scan. Write a fastmap now
+	 * so that the next attach does not have to.
+	 */
+	if (!ubi->fm && !ubi->fm_disabled && !ubi->ro_mode) {
+		err = ubi_update_fastmap(ubi);
+		if (err)
+			ubi_warn(ubi, "unable to write a fastmap: %d", err);
+	}
+#endif
+
 	err = uif_init(ubi, &ref);
 	if (err)
 		goto out_detach;
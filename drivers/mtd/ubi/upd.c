@@ -371,6 +371,11 @@ int ubi_more_update_data(struct ubi_device *ubi, struct ubi_volume *vol,
 		vol->updating = 0;
 		err = to_write;
 		vfree(vol->upd_buf);
+#ifdef CONFIG_MTD_UBI_FASTMAP_KEEP
+		/* U-Boot may not detach before booting, record the update */
+		if (ubi_update_fastmap(ubi))
+			ubi_warn(ubi, "unable to write a fastmap");
+#endif
 	}
 
 	return err;
@@ -56,15 +56,9 @@ static int console_normal_set_row(struct udevice *dev, uint row, int clr)
 static int console_normal_move_rows(struct udevice *dev, uint rowdst,
 				     uint rowsrc, uint count)
 {
-	struct video_priv *vid_priv = dev_get_uclass_priv(dev->parent);
-	void *dst;
-	void *src;
-
-	dst = vid_priv->fb + rowdst * VIDEO_FONT_HEIGHT * vid_priv->line_length;
-	src = vid_priv->fb + rowsrc * VIDEO_FONT_HEIGHT * vid_priv->line_length;
-	memmove(dst, src, VIDEO_FONT_HEIGHT * vid_priv->line_length * count);
-
-	return 0;
+	return video_move_lines(dev->parent, rowdst * VIDEO_FONT_HEIGHT,
+				rowsrc * VIDEO_FONT_HEIGHT,
+				count * VIDEO_FONT_HEIGHT);
 }
 
 static int console_normal_putc_xy(struct udevice *dev, uint x_frac, uint y,
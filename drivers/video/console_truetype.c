@@ -93,6 +93,34 @@ struct pos_info {
  */
 #define POS_HISTORY_SIZE	(CONFIG_SYS_CBSIZE * 11 / 10)
 
+/**
+ * struct glyph_info - A rendered character, held in the glyph cache
+ *
+ * The image depends on the sub-pixel position as well as the character, so
+ * both are used to look it up. All glyphs in the cache use the console's
+ * font and size.
+ *
+ * @valid:	true if this entry holds a glyph
+ * @ch:		Character that was rendered
+ * @x_shift:	Fractional X position it was rendered at, from 0 to 1
+ * @bits:	8-bit-per-pixel image of the character, or NULL if it has no
+ *		image (e.g. ' ')
+ * @width:	Width of the image in pixels
+ * @height:	Height of the image in pixels
+ * @xoff:	X offset of the image from the cursor position
+ * @yoff:	Y offset of the image from the baseline
+ */
+struct glyph_info {
+	bool valid;
+	int ch;
+	double x_shift;
+	u8 *bits;
+	int width;
+	int height;
+	int xoff;
+	int yoff;
+};
+
 /**
  * struct console_tt_priv - Private data for this driver
  *
@@ -112,6 +140,8 @@ struct pos_info {
  * @scale:	Scale of the font. This is calculated from the pixel height
  *		of the font. It is used by the STB library to generate images
  *		of the correct size.
+ * @glyph_cache:	Cache of rendered characters, with
+ *		CONFIG_CONSOLE_TRUETYPE_GLYPH_CACHE entries, or NULL if none
  */
 struct console_tt_priv {
 	int font_size;
@@ -121,6 +151,7 @@ struct console_tt_priv {
 	int pos_ptr;
 	int baseline;
 	double scale;
+	struct glyph_info *glyph_cache;
 };
 
 static int console_truetype_set_row(struct udevice *dev, uint row, int clr)
@@ -170,15 +201,14 @@ static int console_truetype_set_row(struct udevice *dev, uint row, int clr)
 static int console_truetype_move_rows(struct udevice *dev, uint rowdst,
 				     uint rowsrc, uint count)
 {
-	struct video_priv *vid_priv = dev_get_uclass_priv(dev->parent);
 	struct console_tt_priv *priv = dev_get_priv(dev);
-	void *dst;
-	void *src;
-	int i, diff;
+	int i, diff, ret;
 
-	dst = vid_priv->fb + rowdst * priv->font_size * vid_priv->line_length;
-	src = vid_priv->fb + rowsrc * priv->font_size * vid_priv->line_length;
-	memmove(dst, src, priv->font_size * vid_priv->line_length * count);
+	ret = video_move_lines(dev->parent, rowdst * priv->font_size,
+			       rowsrc * priv->font_size,
+			       count * priv->font_size);
+	if (ret)
+		return ret;
 
 	/* Scroll up our position history */
 	diff = (rowsrc - rowdst) * priv->font_size;
@@ -188,6 +218,51 @@ static int console_truetype_move_rows(struct udevice *dev, uint rowdst,
 	return 0;
 }
 
+/**
+ * console_truetype_get_glyph() - Get the image of a character
+ *
+ * This renders the character unless it is already in the glyph cache. The
+ * image is the same either way.
+ *
+ * @priv:	Private data for the console
+ * @ch:		Character to render
+ * @x_shift:	Fractional X position to render at, from 0 to 1
+ * @tmp:	Glyph to use if there is no cache. The caller must free
+ *		tmp->bits when finished with it
+ * @return glyph information, either a cache entry or @tmp
+ */
+static struct glyph_info *console_truetype_get_glyph(
+		struct console_tt_priv *priv, int ch, double x_shift,
+		struct glyph_info *tmp)
+{
+	struct glyph_info *glyph = tmp;
+
+#if CONFIG_CONSOLE_TRUETYPE_GLYPH_CACHE
+	if (priv->glyph_cache) {
+		uint hash = (uint)ch * 31 + (uint)(x_shift * VID_FRAC_DIV);
+
+		glyph = &priv->glyph_cache[hash %
+					   CONFIG_CONSOLE_TRUETYPE_GLYPH_CACHE];
+		if (glyph->valid && glyph->ch == ch &&
+		    glyph->x_shift == x_shift)
+			return glyph;
+		free(glyph->bits);
+	}
+#endif
+
+	glyph->valid = true;
+	glyph->ch = ch;
+	glyph->x_shift = x_shift;
+	glyph->bits = stbtt_GetCodepointBitmapSubpixel(&priv->font, priv->scale,
+						       priv->scale, x_shift, 0,
+						       ch, &glyph->width,
+						       &glyph->height,
+						       &glyph->xoff,
+						       &glyph->yoff);
+
+	return glyph;
+}
+
 static int console_truetype_putc_xy(struct udevice *dev, uint x, uint y,
 				    char ch)
 {
@@ -196,12 +271,13 @@ static int console_truetype_putc_xy(struct udevice *dev, uint x, uint y,
 	struct video_priv *vid_priv = dev_get_uclass_priv(vid);
 	struct console_tt_priv *priv = dev_get_priv(dev);
 	stbtt_fontinfo *font = &priv->font;
-	int width, height, xoff, yoff;
+	struct glyph_info *glyph, tmp;
 	double xpos, x_shift;
 	int lsb;
 	int width_frac, linenum;
 	struct pos_info *pos;
-	u8 *bits, *data;
+	u8 inv;
+	u8 *bits;
 	int advance;
 	void *line;
 	int row;
@@ -242,82 +318,84 @@ static int console_truetype_putc_xy(struct udevice *dev, uint x, uint y,
 	/*
 	 * Figure out how much past the start of a pixel we are, and pass this
 	 * information into the render, which will return a 8-bit-per-pixel
-	 * image of the character. For empty characters, like ' ', data will
-	 * return NULL;
+	 * image of the character. For empty characters, like ' ', there is no
+	 * image.
 	 */
-	data = stbtt_GetCodepointBitmapSubpixel(font, priv->scale, priv->scale,
-						x_shift, 0, ch, &width, &height,
-						&xoff, &yoff);
-	if (!data)
+	glyph = console_truetype_get_glyph(priv, ch, x_shift, &tmp);
+	if (!glyph->bits)
 		return width_frac;
 
 	/* Figure out where to write the character in the frame buffer */
-	bits = data;
+	bits = glyph->bits;
 	line = vid_priv->fb + y * vid_priv->line_length +
 		VID_TO_PIXEL(x) * VNBYTES(vid_priv->bpix);
-	linenum = priv->baseline + yoff;
-	if (linenum > 0)
+	linenum = priv->baseline + glyph->yoff;
+	if (linenum > 0) {
 		line += linenum * vid_priv->line_length;
+		y += linenum;
+	}
+	video_damage(vid, y, glyph->height);
 
 	/*
 	 * Write a row at a time, converting the 8bpp image into the colour
 	 * depth of the display. We only expect white-on-black or the reverse
-	 * so the code only handles this simple case.
+	 * so the code only handles this simple case. Inverting the image for
+	 * a light background is the same as XORing each value with 0xff. The
+	 * inner loops have no branches so that the compiler can vectorise
+	 * them.
 	 */
-	for (row = 0; row < height; row++) {
+	inv = vid_priv->colour_bg ? 0xff : 0;
+	for (row = 0; row < glyph->height; row++) {
 		switch (vid_priv->bpix) {
 #ifdef CONFIG_VIDEO_BPP16
 		case VIDEO_BPP16: {
-			uint16_t *dst = (uint16_t *)line + xoff;
+			uint16_t *dst = (uint16_t *)line + glyph->xoff;
 			int i;
 
-			for (i = 0; i < width; i++) {
-				int val = *bits;
-				int out;
-
-				if (vid_priv->colour_bg)
-					val = 255 - val;
-				out = val >> 3 |
-					(val >> 2) << 5 |
-					(val >> 3) << 11;
-				if (vid_priv->colour_fg)
-					*dst++ |= out;
-				else
-					*dst++ &= out;
-				bits++;
+			if (vid_priv->colour_fg) {
+				for (i = 0; i < glyph->width; i++) {
+					uint val = bits[i] ^ inv;
+
+					dst[i] |= val >> 3 | (val >> 2) << 5 |
+						(val >> 3) << 11;
+				}
+			} else {
+				for (i = 0; i < glyph->width; i++) {
+					uint val = bits[i] ^ inv;
+
+					dst[i] &= val >> 3 | (val >> 2) << 5 |
+						(val >> 3) << 11;
+				}
 			}
 			break;
 		}
 #endif
 #ifdef CONFIG_VIDEO_BPP32
 		case VIDEO_BPP32: {
-			u32 *dst = (u32 *)line + xoff;
+			u32 *dst = (u32 *)line + glyph->xoff;
 			int i;
 
-			for (i = 0; i < width; i++) {
-				int val = *bits;
-				int out;
-
-				if (vid_priv->colour_bg)
-					val = 255 - val;
-				out = val | val << 8 | val << 16;
-				if (vid_priv->colour_fg)
-					*dst++ |= out;
-				else
-					*dst++ &= out;
-				bits++;
+			if (vid_priv->colour_fg) {
+				for (i = 0; i < glyph->width; i++)
+					dst[i] |= (bits[i] ^ inv) * 0x010101;
+			} else {
+				for (i = 0; i < glyph->width; i++)
+					dst[i] &= (bits[i] ^ inv) * 0x010101;
 			}
 			break;
 		}
 #endif
 		default:
-			free(data);
+			if (glyph == &tmp)
+				free(tmp.bits);
 			return -ENOSYS;
 		}
 
+		bits += glyph->width;
 		line += vid_priv->line_length;
 	}
-	free(data);
+	if (glyph == &tmp)
+		free(tmp.bits);
 
 	return width_frac;
 }
@@ -551,11 +629,31 @@ static int console_truetype_probe(struct udevice *dev)
 	priv->scale = stbtt_ScaleForPixelHeight(font, priv->font_size);
 	stbtt_GetFontVMetrics(font, &ascent, 0, 0);
 	priv->baseline = (int)(ascent * priv->scale);
+
+	/* Rendering is slow, so keep recent characters if there is memory */
+	if (CONFIG_CONSOLE_TRUETYPE_GLYPH_CACHE)
+		priv->glyph_cache = calloc(CONFIG_CONSOLE_TRUETYPE_GLYPH_CACHE,
+					   sizeof(struct glyph_info));
 	debug("%s: ready\n", __func__);
 
 	return 0;
 }
 
+static int console_truetype_remove(struct udevice *dev)
+{
+	struct console_tt_priv *priv = dev_get_priv(dev);
+	int i;
+
+	if (priv->glyph_cache) {
+		for (i = 0; i < CONFIG_CONSOLE_TRUETYPE_GLYPH_CACHE; i++)
+			free(priv->glyph_cache[i].bits);
+		free(priv->glyph_cache);
+		priv->glyph_cache = NULL;
+	}
+
+	return 0;
+}
+
 struct vidconsole_ops console_truetype_ops = {
 	.putc_xy	= console_truetype_putc_xy,
 	.move_rows	= console_truetype_move_rows,
@@ -569,5 +667,6 @@ U_BOOT_DRIVER(vidconsole_truetype) = {
 	.id	= UCLASS_VIDEO_CONSOLE,
 	.ops	= &console_truetype_ops,
 	.probe	= console_truetype_probe,
+	.remove	= console_truetype_remove,
 	.priv_auto_alloc_size	= sizeof(struct console_tt_priv),
 };
@@ -40,10 +40,21 @@ static int sandbox_sdl_probe(struct udevice *dev)
 	uc_priv->rot = plat->rot;
 	uc_priv->vidconsole_drv_name = plat->vidconsole_drv_name;
 	uc_priv->font_size = plat->font_size;
+	if (plat->pan)
+		uc_priv->pan_lines = plat->yres;
 
 	return 0;
 }
 
+static int sandbox_sdl_set_start(struct udevice *dev, ulong offset)
+{
+	/*
+	 * Nothing to do here, since sandbox_sdl_sync() is passed the address
+	 * of the first displayed line
+	 */
+	return 0;
+}
+
 static int sandbox_sdl_bind(struct udevice *dev)
 {
 	struct video_uc_platdata *uc_plat = dev_get_uclass_platdata(dev);
@@ -54,6 +65,9 @@ static int sandbox_sdl_bind(struct udevice *dev)
 	plat->yres = dev_read_u32_default(dev, "yres", LCD_MAX_HEIGHT);
 	plat->bpix = dev_read_u32_default(dev, "log2-depth", VIDEO_BPP16);
 	uc_plat->size = plat->xres * plat->yres * (1 << plat->bpix) / 8;
+
+	/* Allow for a second screen below the first, for panning */
+	uc_plat->size *= 2;
 	debug("%s: Frame buffer size %x\n", __func__, uc_plat->size);
 
 	return ret;
@@ -64,11 +78,16 @@ static const struct udevice_id sandbox_sdl_ids[] = {
 	{ }
 };
 
+static const struct video_ops sandbox_sdl_ops = {
+	.set_start	= sandbox_sdl_set_start,
+};
+
 U_BOOT_DRIVER(sdl_sandbox) = {
 	.name	= "sdl_sandbox",
 	.id	= UCLASS_VIDEO,
 	.of_match = sandbox_sdl_ids,
 	.bind	= sandbox_sdl_bind,
 	.probe	= sandbox_sdl_probe,
+	.ops	= &sandbox_sdl_ops,
 	.platdata_auto_alloc_size	= sizeof(struct sandbox_sdl_plat),
 };
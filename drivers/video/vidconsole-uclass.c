@@ -10,6 +10,7 @@
 #include <common.h>
 #include <command.h>
 #include <log.h>
+#include <time.h>
 #include <linux/ctype.h>
 #include <dm.h>
 #include <video.h>
@@ -30,31 +31,60 @@ struct vid_rgb {
 #define CONFIG_CONSOLE_SCROLL_LINES 1
 #endif
 
+/**
+ * vidconsole_damage() - Record the frame-buffer lines used by some text
+ *
+ * @dev:	Console device
+ * @y:		Y position of the text in pixels from the top
+ * @height:	Height of the text in pixels
+ */
+static void vidconsole_damage(struct udevice *dev, int y, int height)
+{
+	struct udevice *vid = dev->parent;
+	struct video_priv *vid_priv = dev_get_uclass_priv(vid);
+
+	/* Text on a rotated console does not map to a range of lines */
+	if (vid_priv->rot)
+		video_damage(vid, 0, vid_priv->ysize);
+	else
+		video_damage(vid, y, height);
+}
+
 int vidconsole_putc_xy(struct udevice *dev, uint x, uint y, char ch)
 {
+	struct vidconsole_priv *priv = dev_get_uclass_priv(dev);
 	struct vidconsole_ops *ops = vidconsole_get_ops(dev);
 
 	if (!ops->putc_xy)
 		return -ENOSYS;
+	vidconsole_damage(dev, y, priv->y_charsize);
+
 	return ops->putc_xy(dev, x, y, ch);
 }
 
 int vidconsole_move_rows(struct udevice *dev, uint rowdst, uint rowsrc,
 			 uint count)
 {
+	struct vidconsole_priv *priv = dev_get_uclass_priv(dev);
 	struct vidconsole_ops *ops = vidconsole_get_ops(dev);
 
 	if (!ops->move_rows)
 		return -ENOSYS;
+	vidconsole_damage(dev, rowdst * priv->y_charsize,
+			  count * priv->y_charsize);
+
 	return ops->move_rows(dev, rowdst, rowsrc, count);
 }
 
 int vidconsole_set_row(struct udevice *dev, uint row, int clr)
 {
+	struct vidconsole_priv *priv = dev_get_uclass_priv(dev);
 	struct vidconsole_ops *ops = vidconsole_get_ops(dev);
 
 	if (!ops->set_row)
 		return -ENOSYS;
+	vidconsole_damage(dev, row * priv->y_charsize, priv->y_charsize);
+
 	return ops->set_row(dev, row, clr);
 }
 
@@ -76,8 +106,11 @@ static int vidconsole_back(struct udevice *dev)
 
 	if (ops->backspace) {
 		ret = ops->backspace(dev);
-		if (ret != -ENOSYS)
+		if (ret != -ENOSYS) {
+			/* The driver erased from the new cursor position */
+			vidconsole_damage(dev, priv->ycur, priv->y_charsize);
 			return ret;
+		}
 	}
 
 	priv->xcur_frac -= VID_TO_POS(priv->x_charsize);
@@ -662,6 +695,57 @@ static int do_video_puts(struct cmd_tbl *cmdtp, int flag, int argc,
 	return 0;
 }
 
+#ifdef CONFIG_CMD_VIDBENCH
+static int do_video_bench(struct cmd_tbl *cmdtp, int flag, int argc,
+			  char *const argv[])
+{
+	struct vidconsole_priv *priv;
+	struct video_priv *vid_priv;
+	struct udevice *dev;
+	int lines = 200;
+	ulong start, us;
+	int i, col;
+
+	if (argc > 2)
+		return CMD_RET_USAGE;
+	if (argc == 2)
+		lines = simple_strtoul(argv[1], NULL, 10);
+	if (lines < 1)
+		return CMD_RET_USAGE;
+
+	if (uclass_first_device_err(UCLASS_VIDEO_CONSOLE, &dev))
+		return CMD_RET_FAILURE;
+	priv = dev_get_uclass_priv(dev);
+	vid_priv = dev_get_uclass_priv(dev->parent);
+
+	/*
+	 * Fill each line but the last column, so that it does not wrap. Sync
+	 * after each line as the console does, so that the cost of copying
+	 * to the display is included
+	 */
+	start = timer_get_us();
+	for (i = 0; i < lines; i++) {
+		for (col = 0; col < priv->cols - 1; col++)
+			vidconsole_put_char(dev, ' ' + 1 + (i + col) % 94);
+		vidconsole_put_char(dev, '\n');
+		video_sync(dev->parent, false);
+	}
+	us = timer_get_us() - start;
+
+	printf("%d lines of %d chars in %lu us, %lu us/line (%s)\n", lines,
+	       priv->cols - 1, us, us / lines,
+	       vid_priv->pan_lines ? "panning" : "copying");
+
+	return 0;
+}
+
+U_BOOT_CMD(
+	vidbench, 2,	0,	do_video_bench,
+	"measure video console text output speed",
+	"[<lines>]  - write lines of text to the display and show the time taken"
+);
+#endif
+
 U_BOOT_CMD(
 	setcurs, 3,	1,	do_video_setcursor,
 	"set cursor position within screen",
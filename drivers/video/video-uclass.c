@@ -90,15 +90,18 @@ int video_reserve(ulong *addrp)
 	return 0;
 }
 
-int video_clear(struct udevice *dev)
+/* Set some lines of the display to the background colour */
+static void video_fill_lines(struct udevice *dev, int y, int count)
 {
 	struct video_priv *priv = dev_get_uclass_priv(dev);
+	void *start = priv->fb + y * priv->line_length;
+	int size = count * priv->line_length;
 
 	switch (priv->bpix) {
 	case VIDEO_BPP16:
 		if (IS_ENABLED(CONFIG_VIDEO_BPP16)) {
-			u16 *ppix = priv->fb;
-			u16 *end = priv->fb + priv->fb_size;
+			u16 *ppix = start;
+			u16 *end = start + size;
 
 			while (ppix < end)
 				*ppix++ = priv->colour_bg;
@@ -106,17 +109,118 @@ int video_clear(struct udevice *dev)
 		}
 	case VIDEO_BPP32:
 		if (IS_ENABLED(CONFIG_VIDEO_BPP32)) {
-			u32 *ppix = priv->fb;
-			u32 *end = priv->fb + priv->fb_size;
+			u32 *ppix = start;
+			u32 *end = start + size;
 
 			while (ppix < end)
 				*ppix++ = priv->colour_bg;
 			break;
 		}
 	default:
-		memset(priv->fb, priv->colour_bg, priv->fb_size);
+		memset(start, priv->colour_bg, size);
 		break;
 	}
+	video_damage(dev, y, count);
+}
+
+int video_clear(struct udevice *dev)
+{
+	struct video_priv *priv = dev_get_uclass_priv(dev);
+
+	video_fill_lines(dev, 0, priv->ysize);
+
+	return 0;
+}
+
+/**
+ * video_pan() - Scroll the display up by panning
+ *
+ * This moves the start of the display down through the frame-buffer memory.
+ * When it reaches the end, the display is copied back to the start of the
+ * memory, so only one copy is needed for every @pan_lines lines scrolled.
+ *
+ * @dev:	Video device
+ * @lines:	Number of lines to scroll by
+ * @return 0 if OK, -ENOSYS if the display cannot pan, other -ve on error
+ */
+static int video_pan(struct udevice *dev, int lines)
+{
+	struct video_priv *priv = dev_get_uclass_priv(dev);
+	struct video_ops *ops = video_get_ops(dev);
+	ulong step = lines * priv->line_length;
+	ulong offset = priv->fb - priv->fb_base;
+	int ret;
+
+	if (!priv->pan_lines || !ops || !ops->set_start ||
+	    lines >= priv->ysize)
+		return -ENOSYS;
+
+	/* The displayed lines are about to move, so sync them first */
+	video_sync(dev, true);
+	if (offset + step > priv->pan_lines * priv->line_length) {
+		memmove(priv->fb_base, priv->fb + step, priv->fb_size - step);
+		offset = 0;
+		video_damage(dev, 0, priv->ysize);
+	} else {
+		offset += step;
+	}
+	ret = ops->set_start(dev, offset);
+	if (ret)
+		return log_msg_ret("pan", ret);
+	priv->fb = priv->fb_base + offset;
+
+	/* Clear the lines which have scrolled into view */
+	video_fill_lines(dev, priv->ysize - lines, lines);
+
+	return 0;
+}
+
+int video_unpan(struct udevice *dev)
+{
+	struct video_priv *priv = dev_get_uclass_priv(dev);
+	struct video_ops *ops = video_get_ops(dev);
+	int ret;
+
+	if (!priv->pan_lines)
+		return 0;
+
+	/* Stop panning, so the display stays at the start of the memory */
+	priv->pan_lines = 0;
+	if (priv->fb == priv->fb_base)
+		return 0;
+	memmove(priv->fb_base, priv->fb, priv->fb_size);
+	ret = ops->set_start(dev, 0);
+	if (ret)
+		return log_msg_ret("unpan", ret);
+	priv->fb = priv->fb_base;
+	video_damage(dev, 0, priv->ysize);
+	video_sync(dev, true);
+
+	return 0;
+}
+
+void video_unpan_all(void)
+{
+	struct udevice *dev;
+
+	for (uclass_find_first_device(UCLASS_VIDEO, &dev);
+	     dev;
+	     uclass_find_next_device(&dev)) {
+		if (device_active(dev))
+			video_unpan(dev);
+	}
+}
+
+int video_move_lines(struct udevice *vid, int ydst, int ysrc, int count)
+{
+	struct video_priv *priv = dev_get_uclass_priv(vid);
+
+	if (!ydst && ysrc > 0 && !video_pan(vid, ysrc))
+		return 0;
+	memmove(priv->fb + ydst * priv->line_length,
+		priv->fb + ysrc * priv->line_length,
+		count * priv->line_length);
+	video_damage(vid, ydst, count);
 
 	return 0;
 }
@@ -147,31 +251,61 @@ void video_set_default_colors(struct udevice *dev, bool invert)
 	priv->colour_bg = vid_console_color(priv, back);
 }
 
+void video_damage(struct udevice *vid, int y, int height)
+{
+	struct video_priv *priv = dev_get_uclass_priv(vid);
+	int yend = y + height;
+
+	if (y < 0)
+		y = 0;
+	if (yend > priv->ysize)
+		yend = priv->ysize;
+	if (y >= yend)
+		return;
+
+	if (priv->damage_yend <= priv->damage_ystart) {
+		priv->damage_ystart = y;
+		priv->damage_yend = yend;
+	} else {
+		priv->damage_ystart = min(priv->damage_ystart, y);
+		priv->damage_yend = max(priv->damage_yend, yend);
+	}
+}
+
 /* Flush video activity to the caches */
 void video_sync(struct udevice *vid, bool force)
 {
+	struct video_priv *priv = dev_get_uclass_priv(vid);
+
+	/* Nothing has changed since the last sync */
+	if (priv->damage_yend <= priv->damage_ystart)
+		return;
+
 	/*
 	 * flush_dcache_range() is declared in common.h but it seems that some
 	 * architectures do not actually implement it. Is there a way to find
 	 * out whether it exists? For now, ARM is safe.
 	 */
 #if defined(CONFIG_ARM) && !CONFIG_IS_ENABLED(SYS_DCACHE_OFF)
-	struct video_priv *priv = dev_get_uclass_priv(vid);
-
 	if (priv->flush_dcache) {
-		flush_dcache_range((ulong)priv->fb,
-				   ALIGN((ulong)priv->fb + priv->fb_size,
-					 CONFIG_SYS_CACHELINE_SIZE));
+		ulong start, end;
+
+		start = (ulong)priv->fb + priv->damage_ystart * priv->line_length;
+		end = (ulong)priv->fb + priv->damage_yend * priv->line_length;
+		flush_dcache_range(round_down(start, CONFIG_SYS_CACHELINE_SIZE),
+				   ALIGN(end, CONFIG_SYS_CACHELINE_SIZE));
 	}
 #elif defined(CONFIG_VIDEO_SANDBOX_SDL)
-	struct video_priv *priv = dev_get_uclass_priv(vid);
 	static ulong last_sync;
 
-	if (force || get_timer(last_sync) > 10) {
-		sandbox_sdl_sync(priv->fb);
-		last_sync = get_timer(0);
-	}
+	/* Keep the damage so that a later sync picks it up */
+	if (!force && get_timer(last_sync) <= 10)
+		return;
+	sandbox_sdl_sync(priv->fb);
+	last_sync = get_timer(0);
 #endif
+	priv->damage_ystart = 0;
+	priv->damage_yend = 0;
 }
 
 void video_sync_all(void)
@@ -181,8 +315,10 @@ void video_sync_all(void)
 	for (uclass_find_first_device(UCLASS_VIDEO, &dev);
 	     dev;
 	     uclass_find_next_device(&dev)) {
-		if (device_active(dev))
+		if (device_active(dev)) {
+			video_damage(dev, 0, video_get_ysize(dev));
 			video_sync(dev, true);
+		}
 	}
 }
 
@@ -216,6 +352,7 @@ static int video_pre_remove(struct udevice *dev)
 {
 	struct video_priv *priv = dev_get_uclass_priv(dev);
 
+	video_unpan(dev);
 	free(priv->cmap);
 
 	return 0;
@@ -233,11 +370,15 @@ static int video_post_probe(struct udevice *dev)
 
 	/* Set up the line and display size */
 	priv->fb = map_sysmem(plat->base, plat->size);
+	priv->fb_base = priv->fb;
 	if (!priv->line_length)
 		priv->line_length = priv->xsize * VNBYTES(priv->bpix);
 
 	priv->fb_size = priv->line_length * priv->ysize;
 
+	/* The first sync must cover the whole frame buffer */
+	video_damage(dev, 0, priv->ysize);
+
 	/* Set up colors  */
 	video_set_default_colors(dev, false);
 
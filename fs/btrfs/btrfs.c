@@ -8,11 +8,25 @@
 #include "btrfs.h"
 #include <config.h>
 #include <malloc.h>
+#include <part.h>
 #include <uuid.h>
 #include <linux/time.h>
 
 struct btrfs_info btrfs_info;
 
+/*
+ * Key of the extent cache. The superblock generation is bumped by every
+ * transaction, so with the fsid it tells whether the filesystem on this
+ * partition has been replaced or written since the extents were cached.
+ */
+static struct {
+	struct blk_desc *desc;
+	lbaint_t start;
+	lbaint_t size;
+	u8 fsid[BTRFS_FSID_SIZE];
+	u64 generation;
+} cache_fs;
+
 static int readdir_callback(const struct btrfs_root *root,
 			    struct btrfs_dir_item *item)
 {
@@ -87,6 +101,20 @@ int btrfs_probe(struct blk_desc *fs_dev_desc,
 	if (btrfs_read_superblock())
 		return -1;
 
+	/* Drop the extent cache unless it was filled from this very state */
+	if (cache_fs.desc != fs_dev_desc ||
+	    cache_fs.start != fs_partition->start ||
+	    cache_fs.size != fs_partition->size ||
+	    cache_fs.generation != btrfs_info.sb.generation ||
+	    memcmp(cache_fs.fsid, btrfs_info.sb.fsid, BTRFS_FSID_SIZE)) {
+		btrfs_extent_cache_drop();
+		cache_fs.desc = fs_dev_desc;
+		cache_fs.start = fs_partition->start;
+		cache_fs.size = fs_partition->size;
+		cache_fs.generation = btrfs_info.sb.generation;
+		memcpy(cache_fs.fsid, btrfs_info.sb.fsid, BTRFS_FSID_SIZE);
+	}
+
 	if (btrfs_chunk_map_init()) {
 		printf("%s: failed to init chunk map\n", __func__);
 		return -1;
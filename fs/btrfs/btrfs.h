@@ -83,5 +83,7 @@ u64 btrfs_read_extent_inline(struct btrfs_path *,
 			      char *);
 u64 btrfs_read_extent_reg(struct btrfs_path *, struct btrfs_file_extent_item *,
 			   u64, u64, char *);
+int btrfs_read_extent_flush(void);
+void btrfs_extent_cache_drop(void);
 
 #endif /* !__BTRFS_BTRFS_H__ */
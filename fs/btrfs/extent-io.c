@@ -61,15 +61,147 @@ err:
 	return -1ULL;
 }
 
+/*
+ * Decompressed copies of the last few compressed extents read, so that
+ * reading a file in pieces does not decompress the same extent again and
+ * again. An entry is unused if its data is NULL.
+ */
+#define BTRFS_EXTENT_CACHE_SIZE	4
+
+static struct btrfs_extent_cache {
+	u64 disk_bytenr;
+	u64 ram_bytes;
+	u8 compression;
+	char *data;
+	unsigned long last_used;
+} extent_cache[BTRFS_EXTENT_CACHE_SIZE];
+
+static unsigned long extent_cache_clock;
+
+/*
+ * Uncompressed extent data which has not been read yet, so that it can be
+ * merged with the data of a following, physically adjacent extent
+ */
+static struct {
+	u64 physical;
+	u64 len;
+	char *out;
+} pending_read;
+
+void btrfs_extent_cache_drop(void)
+{
+	int i;
+
+	for (i = 0; i < BTRFS_EXTENT_CACHE_SIZE; i++)
+		free(extent_cache[i].data);
+	memset(extent_cache, 0, sizeof(extent_cache));
+	pending_read.len = 0;
+}
+
+static struct btrfs_extent_cache *
+extent_cache_find(struct btrfs_file_extent_item *extent)
+{
+	struct btrfs_extent_cache *entry;
+	int i;
+
+	for (i = 0; i < BTRFS_EXTENT_CACHE_SIZE; i++) {
+		entry = &extent_cache[i];
+		if (entry->data && entry->disk_bytenr == extent->disk_bytenr &&
+		    entry->ram_bytes == extent->ram_bytes &&
+		    entry->compression == extent->compression) {
+			entry->last_used = ++extent_cache_clock;
+			return entry;
+		}
+	}
+
+	return NULL;
+}
+
+/* Take the least recently used entry for @extent and size its buffer */
+static struct btrfs_extent_cache *
+extent_cache_alloc(struct btrfs_file_extent_item *extent)
+{
+	struct btrfs_extent_cache *entry = &extent_cache[0];
+	int i;
+
+	for (i = 1; i < BTRFS_EXTENT_CACHE_SIZE; i++)
+		if (extent_cache[i].last_used < entry->last_used)
+			entry = &extent_cache[i];
+
+	if (!entry->data || entry->ram_bytes < extent->ram_bytes) {
+		free(entry->data);
+		entry->data = malloc(extent->ram_bytes);
+		if (!entry->data)
+			return NULL;
+	}
+	entry->disk_bytenr = extent->disk_bytenr;
+	entry->ram_bytes = extent->ram_bytes;
+	entry->compression = extent->compression;
+	entry->last_used = ++extent_cache_clock;
+
+	return entry;
+}
+
+/*
+ * Decompress a whole extent into @dbuf, which holds extent->ram_bytes bytes.
+ * Compressed data may decompress to less than that, the rest is zeroes.
+ */
+static int decompress_extent(struct btrfs_file_extent_item *extent,
+			     u64 physical, char *dbuf)
+{
+	u64 clen = extent->disk_num_bytes;
+	char *cbuf;
+	u32 res;
+
+	cbuf = malloc_cache_aligned(clen);
+	if (!cbuf)
+		return -1;
+
+	if (!btrfs_devread(physical, clen, cbuf)) {
+		free(cbuf);
+		return -1;
+	}
+
+	res = btrfs_decompress(extent->compression, cbuf, clen, dbuf,
+			       extent->ram_bytes);
+	free(cbuf);
+	if (res == -1 || res > extent->ram_bytes)
+		return -1;
+	memset(dbuf + res, 0, extent->ram_bytes - res);
+
+	return 0;
+}
+
+/**
+ * btrfs_read_extent_flush() - Read data queued by btrfs_read_extent_reg()
+ *
+ * @return 0 if OK, -1 on error
+ */
+int btrfs_read_extent_flush(void)
+{
+	int ret = 0;
+
+	if (pending_read.len &&
+	    !btrfs_devread(pending_read.physical, pending_read.len,
+			   pending_read.out))
+		ret = -1;
+	pending_read.len = 0;
+
+	return ret;
+}
+
+/*
+ * Reads of uncompressed data are queued and merged with reads of physically
+ * and logically adjacent extents. btrfs_read_extent_flush() must be called
+ * before the data is used.
+ */
 u64 btrfs_read_extent_reg(struct btrfs_path *path,
 			  struct btrfs_file_extent_item *extent, u64 offset,
 			  u64 size, char *out)
 {
-	u64 physical, clen, dlen, orig_size = size;
-	u32 res;
-	char *cbuf, *dbuf;
+	struct btrfs_extent_cache *entry;
+	u64 physical, dlen;
 
-	clen = extent->disk_num_bytes;
 	dlen = extent->num_bytes;
 
 	if (offset > dlen)
@@ -90,37 +222,51 @@ u64 btrfs_read_extent_reg(struct btrfs_path *path,
 
 	if (extent->compression == BTRFS_COMPRESS_NONE) {
 		physical += extent->offset + offset;
-		if (!btrfs_devread(physical, size, out))
+		if (pending_read.len &&
+		    (pending_read.physical + pending_read.len != physical ||
+		     pending_read.out + pending_read.len != out ||
+		     pending_read.len + size > INT_MAX) &&
+		    btrfs_read_extent_flush())
 			return -1ULL;
 
+		if (!pending_read.len) {
+			pending_read.physical = physical;
+			pending_read.out = out;
+		}
+		pending_read.len += size;
+
 		return size;
 	}
 
-	cbuf = malloc_cache_aligned(dlen > size ? clen + dlen : clen);
-	if (!cbuf)
+	/* The extent may only reference part of the decompressed data */
+	offset += extent->offset;
+	if (offset + size > extent->ram_bytes)
 		return -1ULL;
 
-	if (dlen > orig_size)
-		dbuf = cbuf + clen;
-	else
-		dbuf = out;
-
-	if (!btrfs_devread(physical, clen, cbuf))
-		goto err;
+	entry = extent_cache_find(extent);
+	if (entry) {
+		memcpy(out, entry->data + offset, size);
+		return size;
+	}
 
-	res = btrfs_decompress(extent->compression, cbuf, clen, dbuf, dlen);
-	if (res == -1)
-		goto err;
+	/* All of it is wanted, so decompress it straight into place */
+	if (!offset && size == extent->ram_bytes) {
+		if (decompress_extent(extent, physical, out))
+			return -1ULL;
+		return size;
+	}
 
-	if (dlen > orig_size)
-		memcpy(out, dbuf + offset, size);
-	else
-		memmove(out, dbuf + offset, size);
+	entry = extent_cache_alloc(extent);
+	if (!entry)
+		return -1ULL;
 
-	free(cbuf);
-	return res;
+	if (decompress_extent(extent, physical, entry->data)) {
+		free(entry->data);
+		entry->data = NULL;
+		entry->last_used = 0;
+		return -1ULL;
+	}
+	memcpy(out, entry->data + offset, size);
 
-err:
-	free(cbuf);
-	return -1ULL;
+	return size;
 }
@@ -341,6 +341,8 @@ u64 btrfs_file_read(const struct btrfs_root *root, u64 inr, u64 offset,
 	}
 
 	rd_all = 0;
+	/* the first extent may start before the requested offset */
+	offset -= btrfs_path_leaf_key(&path)->offset;
 
 	do {
 		if (btrfs_comp_keys_type(&key, btrfs_path_leaf_key(&path)))
@@ -375,9 +377,12 @@ u64 btrfs_file_read(const struct btrfs_root *root, u64 inr, u64 offset,
 	} while (!(res = btrfs_next_slot(&path)));
 
 	if (res)
-		return -1ULL;
+		rd_all = -1ULL;
 
 out:
+	/* read what is still queued by btrfs_read_extent_reg() */
+	if (btrfs_read_extent_flush())
+		rd_all = -1ULL;
 	btrfs_free_path(&path);
 	return rd_all;
 }
@@ -15,12 +15,15 @@
 #include <ext4fs.h>
 #include <fat.h>
 #include <fs.h>
+#include <gzip.h>
 #include <sandboxfs.h>
 #include <ubifs_uboot.h>
 #include <btrfs.h>
+#include <squashfs.h>
 #include <asm/io.h>
 #include <div64.h>
 #include <linux/math64.h>
+#include <linux/sizes.h>
 #include <efi_loader.h>
 
 DECLARE_GLOBAL_DATA_PTR;
@@ -276,6 +279,27 @@ static struct fstype_info fstypes[] = {
 		.mkdir = fs_mkdir_unsupported,
 		.ln = fs_ln_unsupported,
 	},
+#endif
+#ifdef CONFIG_FS_SQUASHFS
+	{
+		.fstype = FS_TYPE_SQUASHFS,
+		.name = "squashfs",
+		.null_dev_desc_ok = false,
+		.probe = sqfs_probe,
+		.close = sqfs_close,
+		.ls = fs_ls_generic,
+		.exists = sqfs_exists,
+		.size = sqfs_size,
+		.read = sqfs_read,
+		.write = fs_write_unsupported,
+		.uuid = fs_uuid_unsupported,
+		.opendir = sqfs_opendir,
+		.readdir = sqfs_readdir,
+		.closedir = sqfs_closedir,
+		.unlink = fs_unlink_unsupported,
+		.mkdir = fs_mkdir_unsupported,
+		.ln = fs_ln_unsupported,
+	},
 #endif
 	{
 		.fstype = FS_TYPE_ANY,
@@ -532,6 +556,97 @@ int fs_read(const char *filename, ulong addr, loff_t offset, loff_t len,
 	return _fs_read(filename, addr, offset, len, 0, actread);
 }
 
+#if CONFIG_IS_ENABLED(GZIP)
+/* Size of each read of compressed data in fs_read_gunzip() */
+#define FS_GUNZIP_CHUNK		SZ_256K
+
+/**
+ * struct fs_gunzip_priv - State of a file read by fs_read_gunzip()
+ *
+ * @filename: File to read
+ * @pos: Offset of the next byte to read
+ * @size: Size of the file
+ */
+struct fs_gunzip_priv {
+	const char *filename;
+	loff_t pos;
+	loff_t size;
+};
+
+static long fs_gunzip_read(void *priv, void *buf, ulong size)
+{
+	struct fs_gunzip_priv *rd = priv;
+	struct fstype_info *info = fs_get_info(fs_type);
+	loff_t actread;
+	int ret;
+
+	if (rd->pos >= rd->size)
+		return 0;
+	size = min_t(loff_t, size, rd->size - rd->pos);
+
+	ret = info->read(rd->filename, buf, rd->pos, size, &actread);
+	if (ret < 0)
+		return ret;
+	rd->pos += actread;
+
+	return actread;
+}
+
+/* Check the output buffer against reserved memory, sizing it if needed */
+static int fs_gunzip_lmb_check(ulong addr, ulong *maxlenp)
+{
+#ifdef CONFIG_LMB
+	struct lmb lmb;
+	ulong maxlen = *maxlenp;
+
+	lmb_init_and_reserve(&lmb, gd->bd, (void *)gd->fdt_blob);
+	if (!maxlen)
+		maxlen = lmb_get_free_size(&lmb, addr);
+	if (maxlen && lmb_alloc_addr(&lmb, addr, maxlen) == addr) {
+		*maxlenp = maxlen;
+		return 0;
+	}
+
+	printf("** Decompressing file would overwrite reserved memory **\n");
+	return -ENOSPC;
+#else
+	if (*maxlenp)
+		return 0;
+
+	printf("** A maximum size is needed to decompress a file **\n");
+	return -EINVAL;
+#endif
+}
+
+int fs_read_gunzip(const char *filename, ulong addr, ulong maxlen,
+		   ulong *actread)
+{
+	struct fstype_info *info = fs_get_info(fs_type);
+	struct fs_gunzip_priv rd = {
+		.filename = filename,
+	};
+	void *buf;
+	int ret;
+
+	ret = fs_gunzip_lmb_check(addr, &maxlen);
+	if (!ret)
+		ret = info->size(filename, &rd.size);
+	if (ret) {
+		fs_close();
+		return ret;
+	}
+
+	/* Keep the filesystem open until the whole file has been read */
+	buf = map_sysmem(addr, maxlen);
+	ret = gunzip_stream(buf, maxlen, fs_gunzip_read, &rd, FS_GUNZIP_CHUNK,
+			    actread);
+	unmap_sysmem(buf);
+	fs_close();
+
+	return ret ? -EIO : 0;
+}
+#endif
+
 int fs_write(const char *filename, ulong addr, loff_t offset, loff_t len,
 	     loff_t *actwrite)
 {
@@ -739,6 +854,40 @@ int do_load(struct cmd_tbl *cmdtp, int flag, int argc, char *const argv[],
 	return 0;
 }
 
+#if CONFIG_IS_ENABLED(GZIP)
+int do_gzload(struct cmd_tbl *cmdtp, int flag, int argc, char *const argv[],
+	      int fstype)
+{
+	ulong addr, maxlen = 0;
+	ulong len_read;
+	unsigned long time;
+	char *ep;
+
+	if (argc < 5 || argc > 6)
+		return CMD_RET_USAGE;
+
+	if (fs_set_blk_dev(argv[1], argv[2], fstype))
+		return 1;
+
+	addr = simple_strtoul(argv[3], &ep, 16);
+	if (ep == argv[3] || *ep != '\0')
+		return CMD_RET_USAGE;
+	if (argc >= 6)
+		maxlen = simple_strtoul(argv[5], NULL, 16);
+
+	time = get_timer(0);
+	if (fs_read_gunzip(argv[4], addr, maxlen, &len_read))
+		return 1;
+	time = get_timer(time);
+
+	printf("%lu bytes uncompressed in %lu ms\n", len_read, time);
+	env_set_hex("fileaddr", addr);
+	env_set_hex("filesize", len_read);
+
+	return 0;
+}
+#endif
+
 int do_ls(struct cmd_tbl *cmdtp, int flag, int argc, char *const argv[],
 	  int fstype)
 {
@@ -0,0 +1,1001 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * SquashFS filesystem implementation for U-Boot
+ *
+ * Read-only support for SquashFS 4.0 images. Metadata blocks and fragment
+ * blocks are kept in small caches, since looking up a path or reading the
+ * tail ends of several small files would otherwise decompress the same
+ * blocks over and over.
+ */
+
+#include <common.h>
+#include <blk.h>
+#include <errno.h>
+#include <fs.h>
+#include <fs_internal.h>
+#include <log.h>
+#include <malloc.h>
+#include <memalign.h>
+#include <part.h>
+#include <squashfs.h>
+#include <asm/unaligned.h>
+#include <linux/kernel.h>
+#include <linux/string.h>
+#include "sqfs_filesystem.h"
+
+#define SQFS_META_CACHE_SIZE	8
+#define SQFS_FRAG_CACHE_SIZE	3
+
+/* Symbolic links followed while resolving a single path */
+#define SQFS_MAX_SYMLINKS	8
+#define SQFS_MAX_SYMLINK_LEN	4096
+
+/**
+ * struct sqfs_cache_entry - A decompressed metadata or fragment block
+ *
+ * @block: Position of the block on disk
+ * @next: Position of the following block on disk, used for metadata
+ * @len: Number of bytes of uncompressed data, 0 if the entry is unused
+ * @last_used: Value of the cache clock when the entry was last used
+ * @data: Uncompressed data, allocated on first use
+ */
+struct sqfs_cache_entry {
+	u64 block;
+	u64 next;
+	size_t len;
+	ulong last_used;
+	u8 *data;
+};
+
+/**
+ * struct sqfs_inode - Parsed form of the inodes we care about
+ *
+ * The 'long' inode types are reported as their basic counterparts.
+ *
+ * @type: Basic inode type (enum sqfs_inode_type)
+ * @size: File size, directory listing size or symlink target length
+ * @start: Directories: position of the listing in the directory table.
+ *	Regular files: position of the first data block on disk
+ * @offset: Directories: offset of the listing in its metadata block
+ * @frag: Regular files: fragment holding the tail end or SQFS_INVALID_FRAG
+ * @frag_offset: Regular files: offset of the tail end in the fragment
+ * @i_count: Directories: number of directory index entries
+ * @extra_block: Metadata block holding the block list, directory index or
+ *	symlink target which follows the inode
+ * @extra_offset: Offset of that data in @extra_block
+ */
+struct sqfs_inode {
+	u16 type;
+	u64 size;
+	u64 start;
+	u32 offset;
+	u32 frag;
+	u32 frag_offset;
+	u32 i_count;
+	u64 extra_block;
+	u32 extra_offset;
+};
+
+/**
+ * struct sqfs_dir_pos - Position while walking a directory listing
+ *
+ * @block: Metadata block holding the next byte of the listing
+ * @offset: Offset of the next byte in @block
+ * @left: Bytes of listing left
+ * @entries: Entries left under the current directory header
+ * @inode_block: Inode table block of the entries under the current header
+ */
+struct sqfs_dir_pos {
+	u64 block;
+	u32 offset;
+	u32 left;
+	u32 entries;
+	u32 inode_block;
+};
+
+struct sqfs_dir_stream {
+	struct fs_dir_stream parent;
+	struct fs_dirent dirent;
+	struct sqfs_dir_pos pos;
+};
+
+/*
+ * State of the mounted filesystem. An image cannot be modified in place, and
+ * its superblock records when it was made and how large it is, so the same
+ * superblock on the same partition means the tables and cached blocks here
+ * still describe it. ls calls sqfs_probe() for every directory entry.
+ */
+static struct {
+	struct blk_desc *desc;
+	struct disk_partition part;
+	struct sqfs_super_block sblk;
+	u16 comp;
+	u32 block_size;
+	u64 inode_table;
+	u64 dir_table;
+	u64 *frag_index;
+	u8 *cbuf;
+	u8 *dbuf;
+	struct sqfs_cache_entry meta[SQFS_META_CACHE_SIZE];
+	struct sqfs_cache_entry frag[SQFS_FRAG_CACHE_SIZE];
+	ulong clock;
+} ctxt;
+
+static int sqfs_disk_read(u64 start, size_t len, void *buf)
+{
+	lbaint_t sector = start >> ctxt.desc->log2blksz;
+	int offset = start & (ctxt.desc->blksz - 1);
+
+	if (!len)
+		return 0;
+	if (!fs_devread(ctxt.desc, &ctxt.part, sector, offset, len, buf))
+		return -EIO;
+
+	return 0;
+}
+
+static void sqfs_cache_drop(struct sqfs_cache_entry *cache, int count)
+{
+	int i;
+
+	for (i = 0; i < count; i++)
+		free(cache[i].data);
+	memset(cache, 0, count * sizeof(*cache));
+}
+
+static void sqfs_drop(void)
+{
+	sqfs_cache_drop(ctxt.meta, SQFS_META_CACHE_SIZE);
+	sqfs_cache_drop(ctxt.frag, SQFS_FRAG_CACHE_SIZE);
+	free(ctxt.frag_index);
+	free(ctxt.cbuf);
+	free(ctxt.dbuf);
+	sqfs_decompressor_cleanup();
+	memset(&ctxt, 0, sizeof(ctxt));
+}
+
+static struct sqfs_cache_entry *sqfs_cache_find(struct sqfs_cache_entry *cache,
+						int count, u64 block)
+{
+	int i;
+
+	for (i = 0; i < count; i++) {
+		if (cache[i].len && cache[i].block == block) {
+			cache[i].last_used = ++ctxt.clock;
+			return &cache[i];
+		}
+	}
+
+	return NULL;
+}
+
+/* Take the least recently used entry, with a buffer of @size bytes */
+static struct sqfs_cache_entry *sqfs_cache_evict(struct sqfs_cache_entry *cache,
+						 int count, size_t size)
+{
+	struct sqfs_cache_entry *entry = &cache[0];
+	int i;
+
+	for (i = 1; i < count; i++)
+		if (cache[i].last_used < entry->last_used)
+			entry = &cache[i];
+
+	if (!entry->data) {
+		entry->data = malloc_cache_aligned(size);
+		if (!entry->data)
+			return NULL;
+	}
+	entry->len = 0;
+	entry->last_used = ++ctxt.clock;
+
+	return entry;
+}
+
+/*
+ * Read a data or fragment block whose block-list entry is @size into @dst,
+ * which is expected to hold @dst_len bytes of uncompressed data
+ */
+static int sqfs_read_block(u64 start, u32 size, void *dst, size_t dst_len)
+{
+	u32 len = SQFS_DATA_LEN(size);
+	size_t out = dst_len;
+	int ret;
+
+	/* Sparse block */
+	if (!len) {
+		memset(dst, 0, dst_len);
+		return 0;
+	}
+	if (len > ctxt.block_size)
+		return -EINVAL;
+
+	if (size & SQFS_DATA_UNCOMPRESSED) {
+		if (len != dst_len)
+			return -EINVAL;
+		return sqfs_disk_read(start, len, dst);
+	}
+
+	ret = sqfs_disk_read(start, len, ctxt.cbuf);
+	if (ret)
+		return ret;
+	ret = sqfs_decompress(ctxt.comp, dst, &out, ctxt.cbuf, len);
+	if (ret)
+		return ret;
+	if (out != dst_len)
+		return -EINVAL;
+
+	return 0;
+}
+
+/* Get the metadata block at @block, from the cache if possible */
+static int sqfs_get_metadata(u64 block, struct sqfs_cache_entry **entryp)
+{
+	struct sqfs_cache_entry *entry;
+	u64 bytes_used = le64_to_cpu(ctxt.sblk.bytes_used);
+	size_t len, out;
+	u16 hdr;
+	int ret;
+
+	entry = sqfs_cache_find(ctxt.meta, SQFS_META_CACHE_SIZE, block);
+	if (entry) {
+		*entryp = entry;
+		return 0;
+	}
+
+	if (block + sizeof(hdr) > bytes_used)
+		return -EINVAL;
+	entry = sqfs_cache_evict(ctxt.meta, SQFS_META_CACHE_SIZE,
+				 SQFS_METADATA_SIZE);
+	if (!entry)
+		return -ENOMEM;
+
+	/* Read the header and the largest possible block in one go */
+	len = min_t(u64, sizeof(hdr) + SQFS_METADATA_SIZE, bytes_used - block);
+	ret = sqfs_disk_read(block, len, ctxt.cbuf);
+	if (ret)
+		return ret;
+
+	hdr = get_unaligned_le16(ctxt.cbuf);
+	len = SQFS_METADATA_LEN(hdr);
+	if (!len || len > SQFS_METADATA_SIZE ||
+	    sizeof(hdr) + len > bytes_used - block)
+		return -EINVAL;
+
+	if (hdr & SQFS_METADATA_UNCOMPRESSED) {
+		memcpy(entry->data, ctxt.cbuf + sizeof(hdr), len);
+		out = len;
+	} else {
+		out = SQFS_METADATA_SIZE;
+		ret = sqfs_decompress(ctxt.comp, entry->data, &out,
+				      ctxt.cbuf + sizeof(hdr), len);
+		if (ret)
+			return ret;
+		if (!out)
+			return -EINVAL;
+	}
+
+	entry->block = block;
+	entry->next = block + sizeof(hdr) + len;
+	entry->len = out;
+	*entryp = entry;
+
+	return 0;
+}
+
+/*
+ * Copy @len bytes of metadata starting at @offset in the block at @block,
+ * moving on to the following blocks as needed. @block and @offset are
+ * updated to point just after the data.
+ */
+static int sqfs_read_metadata(u64 *block, u32 *offset, void *buf, size_t len)
+{
+	struct sqfs_cache_entry *entry;
+	size_t count;
+	int ret;
+
+	while (len) {
+		ret = sqfs_get_metadata(*block, &entry);
+		if (ret)
+			return ret;
+
+		if (*offset >= entry->len) {
+			if (*offset > entry->len)
+				return -EINVAL;
+			*block = entry->next;
+			*offset = 0;
+			continue;
+		}
+
+		count = min_t(size_t, len, entry->len - *offset);
+		memcpy(buf, entry->data + *offset, count);
+		buf += count;
+		len -= count;
+		*offset += count;
+	}
+
+	return 0;
+}
+
+static int sqfs_read_inode(u64 block, u32 offset, struct sqfs_inode *inode)
+{
+	union {
+		struct sqfs_base_inode base;
+		struct sqfs_dir_inode dir;
+		struct sqfs_ldir_inode ldir;
+		struct sqfs_reg_inode reg;
+		struct sqfs_lreg_inode lreg;
+		struct sqfs_symlink_inode symlink;
+	} raw;
+	size_t size;
+	u16 type;
+	int ret;
+
+	ret = sqfs_read_metadata(&block, &offset, &raw.base, sizeof(raw.base));
+	if (ret)
+		return ret;
+
+	type = le16_to_cpu(raw.base.inode_type);
+	switch (type) {
+	case SQFS_DIR_TYPE:
+		size = sizeof(raw.dir);
+		break;
+	case SQFS_LDIR_TYPE:
+		size = sizeof(raw.ldir);
+		break;
+	case SQFS_REG_TYPE:
+		size = sizeof(raw.reg);
+		break;
+	case SQFS_LREG_TYPE:
+		size = sizeof(raw.lreg);
+		break;
+	case SQFS_SYMLINK_TYPE:
+	case SQFS_LSYMLINK_TYPE:
+		size = sizeof(raw.symlink);
+		break;
+	case SQFS_BLKDEV_TYPE ... SQFS_SOCKET_TYPE:
+	case SQFS_LBLKDEV_TYPE ... SQFS_LSOCKET_TYPE:
+		size = sizeof(raw.base);
+		break;
+	default:
+		debug("%s: unknown inode type %u\n", __func__, type);
+		return -EINVAL;
+	}
+
+	ret = sqfs_read_metadata(&block, &offset, (void *)&raw + sizeof(raw.base),
+				 size - sizeof(raw.base));
+	if (ret)
+		return ret;
+
+	memset(inode, 0, sizeof(*inode));
+	inode->type = type > SQFS_SOCKET_TYPE ? type - SQFS_SOCKET_TYPE : type;
+	inode->frag = SQFS_INVALID_FRAG;
+	inode->extra_block = block;
+	inode->extra_offset = offset;
+
+	switch (type) {
+	case SQFS_DIR_TYPE:
+		inode->size = le16_to_cpu(raw.dir.file_size);
+		inode->start = ctxt.dir_table +
+			le32_to_cpu(raw.dir.start_block);
+		inode->offset = le16_to_cpu(raw.dir.offset);
+		break;
+	case SQFS_LDIR_TYPE:
+		inode->size = le32_to_cpu(raw.ldir.file_size);
+		inode->start = ctxt.dir_table +
+			le32_to_cpu(raw.ldir.start_block);
+		inode->offset = le16_to_cpu(raw.ldir.offset);
+		inode->i_count = le16_to_cpu(raw.ldir.i_count);
+		break;
+	case SQFS_REG_TYPE:
+		inode->size = le32_to_cpu(raw.reg.file_size);
+		inode->start = le32_to_cpu(raw.reg.start_block);
+		inode->frag = le32_to_cpu(raw.reg.fragment);
+		inode->frag_offset = le32_to_cpu(raw.reg.offset);
+		break;
+	case SQFS_LREG_TYPE:
+		inode->size = le64_to_cpu(raw.lreg.file_size);
+		inode->start = le64_to_cpu(raw.lreg.start_block);
+		inode->frag = le32_to_cpu(raw.lreg.fragment);
+		inode->frag_offset = le32_to_cpu(raw.lreg.offset);
+		break;
+	case SQFS_SYMLINK_TYPE:
+	case SQFS_LSYMLINK_TYPE:
+		inode->size = le32_to_cpu(raw.symlink.symlink_size);
+		break;
+	}
+
+	return 0;
+}
+
+static int sqfs_read_root_inode(struct sqfs_inode *inode)
+{
+	u64 ref = le64_to_cpu(ctxt.sblk.root_inode);
+
+	return sqfs_read_inode(ctxt.inode_table + (ref >> 16), ref & 0xffff,
+			       inode);
+}
+
+static void sqfs_dir_start(struct sqfs_inode *dir, struct sqfs_dir_pos *pos)
+{
+	memset(pos, 0, sizeof(*pos));
+	pos->block = dir->start;
+	pos->offset = dir->offset;
+	if (dir->size > SQFS_DIR_SIZE_OFFSET)
+		pos->left = dir->size - SQFS_DIR_SIZE_OFFSET;
+}
+
+/*
+ * Get the next entry of a directory listing, with its name as a string in
+ * @name, which must hold 257 bytes. Returns 1 if an entry was found, 0 at
+ * the end of the directory or -ve on error.
+ */
+static int sqfs_dir_next(struct sqfs_dir_pos *pos, struct sqfs_dir_entry *entry,
+			 char *name)
+{
+	struct sqfs_dir_header hdr;
+	size_t len;
+	int ret;
+
+	if (!pos->entries) {
+		if (pos->left < sizeof(hdr))
+			return 0;
+		ret = sqfs_read_metadata(&pos->block, &pos->offset, &hdr,
+					 sizeof(hdr));
+		if (ret)
+			return ret;
+		pos->left -= sizeof(hdr);
+		pos->entries = le32_to_cpu(hdr.count) + 1;
+		pos->inode_block = le32_to_cpu(hdr.start_block);
+		if (pos->entries > SQFS_DIR_COUNT)
+			return -EINVAL;
+	}
+
+	if (pos->left < sizeof(*entry))
+		return -EINVAL;
+	ret = sqfs_read_metadata(&pos->block, &pos->offset, entry,
+				 sizeof(*entry));
+	if (ret)
+		return ret;
+	pos->left -= sizeof(*entry);
+
+	len = le16_to_cpu(entry->size) + 1;
+	if (len > 256 || len > pos->left)
+		return -EINVAL;
+	ret = sqfs_read_metadata(&pos->block, &pos->offset, name, len);
+	if (ret)
+		return ret;
+	name[len] = '\0';
+	pos->left -= len;
+	pos->entries--;
+
+	return 1;
+}
+
+/*
+ * Compare two names in the order mksquashfs sorts them, which is by unsigned
+ * bytes. strcmp() may compare signed chars, which puts names with a byte of
+ * 0x80 or more in the wrong place
+ */
+static int sqfs_name_cmp(const char *name1, const char *name2)
+{
+	size_t len1 = strlen(name1), len2 = strlen(name2);
+	int ret;
+
+	ret = memcmp(name1, name2, min(len1, len2));
+	if (ret)
+		return ret;
+
+	return len1 < len2 ? -1 : len1 > len2;
+}
+
+/*
+ * Use the index of a large directory to skip the metadata blocks whose
+ * entries all sort before @name
+ */
+static int sqfs_dir_seek(struct sqfs_inode *dir, const char *name,
+			 struct sqfs_dir_pos *pos)
+{
+	u64 block = dir->extra_block;
+	u32 offset = dir->extra_offset;
+	struct sqfs_dir_index index;
+	char index_name[257];
+	u32 skip = 0;
+	size_t len;
+	int i, ret;
+
+	for (i = 0; i < dir->i_count; i++) {
+		ret = sqfs_read_metadata(&block, &offset, &index,
+					 sizeof(index));
+		if (ret)
+			return ret;
+		len = le32_to_cpu(index.size) + 1;
+		if (len > 256)
+			return -EINVAL;
+		ret = sqfs_read_metadata(&block, &offset, index_name, len);
+		if (ret)
+			return ret;
+		index_name[len] = '\0';
+
+		if (sqfs_name_cmp(index_name, name) > 0)
+			break;
+		skip = le32_to_cpu(index.index);
+		pos->block = ctxt.dir_table + le32_to_cpu(index.start_block);
+	}
+
+	if (skip > pos->left)
+		return -EINVAL;
+	pos->offset = (dir->offset + skip) % SQFS_METADATA_SIZE;
+	pos->left -= skip;
+
+	return 0;
+}
+
+/* Look up @name, which is @len bytes long, in directory @dir */
+static int sqfs_dir_lookup(struct sqfs_inode *dir, const char *name,
+			   size_t len, struct sqfs_inode *inode)
+{
+	struct sqfs_dir_entry entry;
+	struct sqfs_dir_pos pos;
+	char target[257], entry_name[257];
+	int cmp, ret;
+
+	if (dir->type != SQFS_DIR_TYPE)
+		return -ENOTDIR;
+	if (len > 256)
+		return -ENAMETOOLONG;
+	memcpy(target, name, len);
+	target[len] = '\0';
+
+	sqfs_dir_start(dir, &pos);
+	if (dir->i_count) {
+		ret = sqfs_dir_seek(dir, target, &pos);
+		if (ret)
+			return ret;
+	}
+
+	while ((ret = sqfs_dir_next(&pos, &entry, entry_name)) > 0) {
+		/* Entries are sorted, so we can stop once past the name */
+		cmp = sqfs_name_cmp(entry_name, target);
+		if (cmp > 0)
+			break;
+		if (!cmp)
+			return sqfs_read_inode(ctxt.inode_table +
+					       pos.inode_block,
+					       le16_to_cpu(entry.offset),
+					       inode);
+	}
+
+	return ret < 0 ? ret : -ENOENT;
+}
+
+/* Remove empty, '.' and '..' components and any leading '/' from @path */
+static void sqfs_normalize_path(char *path)
+{
+	const char *in = path, *end;
+	char *out = path;
+	size_t len;
+
+	while (*in) {
+		end = strchrnul(in, '/');
+		len = end - in;
+		if (len == 2 && in[0] == '.' && in[1] == '.') {
+			while (out > path && *--out != '/')
+				;
+		} else if (len && (len != 1 || in[0] != '.')) {
+			if (out > path)
+				*out++ = '/';
+			memmove(out, in, len);
+			out += len;
+		}
+		in = *end ? end + 1 : end;
+	}
+	*out = '\0';
+}
+
+static int sqfs_read_symlink(struct sqfs_inode *inode, char *buf)
+{
+	u64 block = inode->extra_block;
+	u32 offset = inode->extra_offset;
+	int ret;
+
+	if (inode->size > SQFS_MAX_SYMLINK_LEN)
+		return -ENAMETOOLONG;
+	ret = sqfs_read_metadata(&block, &offset, buf, inode->size);
+	if (ret)
+		return ret;
+	buf[inode->size] = '\0';
+
+	return 0;
+}
+
+/*
+ * Resolve @filename to an inode, following symbolic links in the path and,
+ * if @follow is set, in the last component
+ */
+static int sqfs_lookup(const char *filename, struct sqfs_inode *inode,
+		       bool follow)
+{
+	struct sqfs_inode child;
+	const char *end;
+	char *path, *p, *link, *new_path;
+	int links = 0;
+	int ret;
+
+	path = strdup(filename);
+	link = malloc(SQFS_MAX_SYMLINK_LEN + 1);
+	if (!path || !link) {
+		ret = -ENOMEM;
+		goto out;
+	}
+
+again:
+	sqfs_normalize_path(path);
+	ret = sqfs_read_root_inode(inode);
+	if (ret)
+		goto out;
+
+	for (p = path; *p; p = *end ? (char *)end + 1 : (char *)end) {
+		end = strchrnul(p, '/');
+		ret = sqfs_dir_lookup(inode, p, end - p, &child);
+		if (ret)
+			goto out;
+
+		if (child.type == SQFS_SYMLINK_TYPE && (*end || follow)) {
+			if (++links > SQFS_MAX_SYMLINKS) {
+				ret = -ELOOP;
+				goto out;
+			}
+			ret = sqfs_read_symlink(&child, link);
+			if (ret)
+				goto out;
+
+			/* Replace the path so far with the link target */
+			if (*link == '/')
+				p = path;
+			new_path = malloc((p - path) + strlen(link) +
+					  strlen(end) + 1);
+			if (!new_path) {
+				ret = -ENOMEM;
+				goto out;
+			}
+			memcpy(new_path, path, p - path);
+			strcpy(new_path + (p - path), link);
+			strcat(new_path, end);
+			free(path);
+			path = new_path;
+			goto again;
+		}
+		*inode = child;
+	}
+
+out:
+	free(link);
+	free(path);
+
+	return ret;
+}
+
+/* Get the fragment block @frag, from the cache if possible */
+static int sqfs_get_fragment(u32 frag, struct sqfs_cache_entry **entryp)
+{
+	struct sqfs_fragment_entry fe;
+	struct sqfs_cache_entry *entry;
+	u64 block, start;
+	u32 offset, size;
+	int ret;
+
+	if (frag >= le32_to_cpu(ctxt.sblk.fragments))
+		return -EINVAL;
+
+	block = ctxt.frag_index[frag / SQFS_FRAGMENTS_PER_BLOCK];
+	offset = (frag % SQFS_FRAGMENTS_PER_BLOCK) * sizeof(fe);
+	ret = sqfs_read_metadata(&block, &offset, &fe, sizeof(fe));
+	if (ret)
+		return ret;
+	start = le64_to_cpu(fe.start_block);
+	size = le32_to_cpu(fe.size);
+
+	entry = sqfs_cache_find(ctxt.frag, SQFS_FRAG_CACHE_SIZE, start);
+	if (entry) {
+		*entryp = entry;
+		return 0;
+	}
+	if (!SQFS_DATA_LEN(size) || SQFS_DATA_LEN(size) > ctxt.block_size)
+		return -EINVAL;
+
+	entry = sqfs_cache_evict(ctxt.frag, SQFS_FRAG_CACHE_SIZE,
+				 ctxt.block_size);
+	if (!entry)
+		return -ENOMEM;
+
+	/* Fragment blocks may be shorter than a block, see how much we get */
+	if (size & SQFS_DATA_UNCOMPRESSED) {
+		entry->len = SQFS_DATA_LEN(size);
+		ret = sqfs_read_block(start, size, entry->data, entry->len);
+	} else {
+		entry->len = ctxt.block_size;
+		ret = sqfs_disk_read(start, SQFS_DATA_LEN(size), ctxt.cbuf);
+		if (!ret)
+			ret = sqfs_decompress(ctxt.comp, entry->data,
+					      &entry->len, ctxt.cbuf,
+					      SQFS_DATA_LEN(size));
+	}
+	if (ret) {
+		entry->len = 0;
+		return ret;
+	}
+	entry->block = start;
+	*entryp = entry;
+
+	return 0;
+}
+
+static int sqfs_read_file(struct sqfs_inode *inode, u8 *buf, u64 offset,
+			  u64 len)
+{
+	struct sqfs_cache_entry *frag;
+	u32 block_size = ctxt.block_size;
+	u64 nblocks, first, last, i, pos, boff;
+	u32 *sizes = NULL;
+	size_t blen, skip, count;
+	int ret = 0;
+
+	nblocks = inode->size / block_size;
+	if (inode->frag == SQFS_INVALID_FRAG && inode->size % block_size)
+		nblocks++;
+
+	first = offset / block_size;
+	last = (offset + len - 1) / block_size;
+
+	/* The block list gives the on-disk size of each block in turn */
+	if (first < nblocks) {
+		u64 block = inode->extra_block;
+		u32 list_offset = inode->extra_offset;
+		u64 count = min(last + 1, nblocks);
+
+		sizes = malloc(count * sizeof(*sizes));
+		if (!sizes)
+			return -ENOMEM;
+		ret = sqfs_read_metadata(&block, &list_offset, sizes,
+					 count * sizeof(*sizes));
+		if (ret)
+			goto out;
+	}
+
+	pos = inode->start;
+	for (i = 0; sizes && i < first; i++)
+		pos += SQFS_DATA_LEN(le32_to_cpu(sizes[i]));
+
+	for (i = first; i <= last; i++) {
+		boff = i * block_size;
+		skip = i == first ? offset - boff : 0;
+		count = min_t(u64, block_size - skip, offset + len - boff - skip);
+
+		if (i >= nblocks) {
+			/* The tail end of the file is in a fragment block */
+			ret = sqfs_get_fragment(inode->frag, &frag);
+			if (ret)
+				goto out;
+			if (inode->frag_offset + skip + count > frag->len) {
+				ret = -EINVAL;
+				goto out;
+			}
+			memcpy(buf, frag->data + inode->frag_offset + skip,
+			       count);
+		} else {
+			u32 size = le32_to_cpu(sizes[i]);
+
+			blen = min_t(u64, block_size, inode->size - boff);
+			if (!skip && count == blen) {
+				ret = sqfs_read_block(pos, size, buf, blen);
+			} else {
+				ret = sqfs_read_block(pos, size, ctxt.dbuf,
+						      blen);
+				if (!ret)
+					memcpy(buf, ctxt.dbuf + skip, count);
+			}
+			if (ret)
+				goto out;
+			pos += SQFS_DATA_LEN(size);
+		}
+		buf += count;
+	}
+
+out:
+	free(sizes);
+
+	return ret;
+}
+
+int sqfs_probe(struct blk_desc *fs_dev_desc,
+	       struct disk_partition *fs_partition)
+{
+	ALLOC_CACHE_ALIGN_BUFFER(struct sqfs_super_block, sblk, 1);
+	u32 block_size, frags, count;
+	u16 block_log, comp;
+
+	if (!fs_devread(fs_dev_desc, fs_partition, 0, 0, sizeof(*sblk),
+			(char *)sblk))
+		return -1;
+
+	if (le32_to_cpu(sblk->s_magic) != SQFS_MAGIC)
+		return -1;
+
+	/* Keep the caches if this is the filesystem we have already seen */
+	if (ctxt.desc == fs_dev_desc &&
+	    ctxt.part.start == fs_partition->start &&
+	    ctxt.part.size == fs_partition->size &&
+	    !memcmp(&ctxt.sblk, sblk, sizeof(*sblk)))
+		return 0;
+	sqfs_drop();
+
+	block_size = le32_to_cpu(sblk->block_size);
+	block_log = le16_to_cpu(sblk->block_log);
+	comp = le16_to_cpu(sblk->compression);
+	if (le16_to_cpu(sblk->s_major) != SQFS_MAJOR ||
+	    block_log < SQFS_MIN_BLOCK_LOG || block_log > SQFS_MAX_BLOCK_LOG ||
+	    block_size != 1 << block_log) {
+		printf("SquashFS: unsupported version or block size\n");
+		return -1;
+	}
+	if (!sqfs_decompressor_supported(comp)) {
+		printf("SquashFS: unsupported compression %u\n", comp);
+		return -1;
+	}
+
+	ctxt.desc = fs_dev_desc;
+	ctxt.part = *fs_partition;
+	ctxt.comp = comp;
+	ctxt.block_size = block_size;
+	ctxt.inode_table = le64_to_cpu(sblk->inode_table_start);
+	ctxt.dir_table = le64_to_cpu(sblk->directory_table_start);
+
+	/* Room for a compressed data block or a metadata block and header */
+	ctxt.cbuf = malloc_cache_aligned(max_t(u32, block_size,
+					       SQFS_METADATA_SIZE + 2));
+	ctxt.dbuf = malloc_cache_aligned(block_size);
+	if (!ctxt.cbuf || !ctxt.dbuf)
+		goto err;
+
+	frags = le32_to_cpu(sblk->fragments);
+	if (frags) {
+		count = DIV_ROUND_UP(frags, SQFS_FRAGMENTS_PER_BLOCK);
+		ctxt.frag_index = malloc_cache_aligned(count * sizeof(u64));
+		if (!ctxt.frag_index ||
+		    sqfs_disk_read(le64_to_cpu(sblk->fragment_table_start),
+				   count * sizeof(u64), ctxt.frag_index))
+			goto err;
+		for (; count; count--)
+			ctxt.frag_index[count - 1] =
+				le64_to_cpu(ctxt.frag_index[count - 1]);
+	}
+
+	/* Only remember the superblock once everything is set up */
+	ctxt.sblk = *sblk;
+
+	return 0;
+
+err:
+	sqfs_drop();
+	return -1;
+}
+
+int sqfs_opendir(const char *filename, struct fs_dir_stream **dirsp)
+{
+	struct sqfs_dir_stream *dirs;
+	struct sqfs_inode inode;
+	int ret;
+
+	ret = sqfs_lookup(filename, &inode, true);
+	if (ret)
+		return ret;
+	if (inode.type != SQFS_DIR_TYPE)
+		return -ENOTDIR;
+
+	dirs = calloc(1, sizeof(*dirs));
+	if (!dirs)
+		return -ENOMEM;
+	sqfs_dir_start(&inode, &dirs->pos);
+	*dirsp = &dirs->parent;
+
+	return 0;
+}
+
+int sqfs_readdir(struct fs_dir_stream *fs_dirs, struct fs_dirent **dentp)
+{
+	struct sqfs_dir_stream *dirs;
+	struct sqfs_dir_entry entry;
+	struct sqfs_inode inode;
+	struct fs_dirent *dent;
+	int ret;
+
+	dirs = container_of(fs_dirs, struct sqfs_dir_stream, parent);
+	dent = &dirs->dirent;
+	memset(dent, 0, sizeof(*dent));
+
+	ret = sqfs_dir_next(&dirs->pos, &entry, dent->name);
+	if (ret <= 0)
+		return ret ? ret : -ENOENT;
+
+	switch (le16_to_cpu(entry.type)) {
+	case SQFS_DIR_TYPE:
+		dent->type = FS_DT_DIR;
+		break;
+	case SQFS_SYMLINK_TYPE:
+		dent->type = FS_DT_LNK;
+		break;
+	case SQFS_REG_TYPE:
+		ret = sqfs_read_inode(ctxt.inode_table + dirs->pos.inode_block,
+				      le16_to_cpu(entry.offset), &inode);
+		if (ret)
+			return ret;
+		dent->size = inode.size;
+		/* fall through */
+	default:
+		dent->type = FS_DT_REG;
+		break;
+	}
+	*dentp = dent;
+
+	return 0;
+}
+
+void sqfs_closedir(struct fs_dir_stream *dirs)
+{
+	free(container_of(dirs, struct sqfs_dir_stream, parent));
+}
+
+int sqfs_exists(const char *filename)
+{
+	struct sqfs_inode inode;
+
+	return !sqfs_lookup(filename, &inode, true);
+}
+
+int sqfs_size(const char *filename, loff_t *size)
+{
+	struct sqfs_inode inode;
+
+	if (sqfs_lookup(filename, &inode, true))
+		return -1;
+	*size = inode.size;
+
+	return 0;
+}
+
+int sqfs_read(const char *filename, void *buf, loff_t offset, loff_t len,
+	      loff_t *actread)
+{
+	struct sqfs_inode inode;
+	int ret;
+
+	*actread = 0;
+	ret = sqfs_lookup(filename, &inode, true);
+	if (ret) {
+		printf("Cannot lookup file %s\n", filename);
+		return -1;
+	}
+	if (inode.type != SQFS_REG_TYPE) {
+		printf("Not a regular file: %s\n", filename);
+		return -1;
+	}
+
+	if (offset >= inode.size)
+		return 0;
+	if (!len || len > inode.size - offset)
+		len = inode.size - offset;
+
+	ret = sqfs_read_file(&inode, buf, offset, len);
+	if (ret) {
+		printf("An error occurred while reading file %s\n", filename);
+		return -1;
+	}
+	*actread = len;
+
+	return 0;
+}
+
+void sqfs_close(void)
+{
+	/* Keep the state, sqfs_probe() checks whether it is still valid */
+}
@@ -0,0 +1,138 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * SquashFS filesystem implementation for U-Boot
+ *
+ * Decompressors for metadata and data blocks
+ */
+
+#include <common.h>
+#include <errno.h>
+#include <log.h>
+#include <lz4.h>
+#include <malloc.h>
+#include <linux/lzo.h>
+#include <linux/zstd.h>
+#include <lzma/LzmaTypes.h>
+#include <lzma/LzmaDec.h>
+#include <lzma/LzmaTools.h>
+#include <u-boot/zlib.h>
+#include "sqfs_filesystem.h"
+
+static int sqfs_zlib(void *dst, size_t *dst_len, const void *src,
+		     size_t src_len)
+{
+	z_stream stream;
+	int ret;
+
+	memset(&stream, 0, sizeof(stream));
+	stream.next_in = (void *)src;
+	stream.avail_in = src_len;
+	stream.next_out = dst;
+	stream.avail_out = *dst_len;
+
+	if (inflateInit2(&stream, MAX_WBITS) != Z_OK)
+		return -ENOMEM;
+
+	ret = inflate(&stream, Z_FINISH);
+	*dst_len = stream.total_out;
+	inflateEnd(&stream);
+
+	return ret == Z_STREAM_END ? 0 : -EIO;
+}
+
+/*
+ * The zstd context is large, so keep it around rather than setting it up
+ * again for every block
+ */
+static void *zstd_workspace;
+static ZSTD_DCtx *zstd_ctx;
+
+static int sqfs_zstd(void *dst, size_t *dst_len, const void *src,
+		     size_t src_len)
+{
+	size_t ret;
+
+	if (!zstd_ctx) {
+		size_t wsize = ZSTD_DCtxWorkspaceBound();
+
+		zstd_workspace = malloc(wsize);
+		if (!zstd_workspace)
+			return -ENOMEM;
+		zstd_ctx = ZSTD_initDCtx(zstd_workspace, wsize);
+		if (!zstd_ctx) {
+			free(zstd_workspace);
+			zstd_workspace = NULL;
+			return -ENOMEM;
+		}
+	}
+
+	ret = ZSTD_decompressDCtx(zstd_ctx, dst, *dst_len, src, src_len);
+	if (ZSTD_isError(ret)) {
+		debug("%s: zstd error %d\n", __func__, ZSTD_getErrorCode(ret));
+		return -EIO;
+	}
+	*dst_len = ret;
+
+	return 0;
+}
+
+void sqfs_decompressor_cleanup(void)
+{
+	free(zstd_workspace);
+	zstd_workspace = NULL;
+	zstd_ctx = NULL;
+}
+
+bool sqfs_decompressor_supported(u16 comp)
+{
+	switch (comp) {
+	case SQFS_COMP_ZLIB:
+		return true;
+	case SQFS_COMP_LZMA:
+		return CONFIG_IS_ENABLED(LZMA);
+	case SQFS_COMP_LZO:
+		return CONFIG_IS_ENABLED(LZO);
+	case SQFS_COMP_LZ4:
+		return CONFIG_IS_ENABLED(LZ4);
+	case SQFS_COMP_ZSTD:
+		return CONFIG_IS_ENABLED(ZSTD);
+	default:
+		/* There is no XZ decoder in U-Boot */
+		return false;
+	}
+}
+
+int sqfs_decompress(u16 comp, void *dst, size_t *dst_len, const void *src,
+		    size_t src_len)
+{
+	SizeT len;
+	int ret;
+
+	switch (comp) {
+	case SQFS_COMP_ZLIB:
+		return sqfs_zlib(dst, dst_len, src, src_len);
+	case SQFS_COMP_LZMA:
+		if (!CONFIG_IS_ENABLED(LZMA))
+			break;
+		/* Blocks are in the LZMA 'alone' format, with a 13-byte header */
+		len = *dst_len;
+		ret = lzmaBuffToBuffDecompress(dst, &len, (void *)src, src_len);
+		*dst_len = len;
+		return ret == SZ_OK ? 0 : -EIO;
+	case SQFS_COMP_LZO:
+		if (!CONFIG_IS_ENABLED(LZO))
+			break;
+		ret = lzo1x_decompress_safe(src, src_len, dst, dst_len);
+		return ret == LZO_E_OK ? 0 : -EIO;
+	case SQFS_COMP_LZ4:
+		if (!CONFIG_IS_ENABLED(LZ4))
+			break;
+		return ulz4_block(src, src_len, dst, dst_len);
+	case SQFS_COMP_ZSTD:
+		if (!CONFIG_IS_ENABLED(ZSTD))
+			break;
+		return sqfs_zstd(dst, dst_len, src, src_len);
+	}
+
+	return -EPROTONOSUPPORT;
+}
@@ -0,0 +1,204 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * SquashFS filesystem implementation for U-Boot
+ *
+ * On-disk format definitions, see Documentation/filesystems/squashfs.rst in
+ * Linux for a description of the layout.
+ */
+
+#ifndef __SQFS_FILESYSTEM_H__
+#define __SQFS_FILESYSTEM_H__
+
+#include <linux/types.h>
+
+#define SQFS_MAGIC			0x73717368
+#define SQFS_MAJOR			4
+
+/* Metadata blocks hold at most this many bytes once uncompressed */
+#define SQFS_METADATA_SIZE		8192
+#define SQFS_METADATA_UNCOMPRESSED	BIT(15)
+#define SQFS_METADATA_LEN(hdr)		((hdr) & ~SQFS_METADATA_UNCOMPRESSED)
+
+/* Sizes in the block list of a file and in the fragment table */
+#define SQFS_DATA_UNCOMPRESSED		BIT(24)
+#define SQFS_DATA_LEN(size)		((size) & ~SQFS_DATA_UNCOMPRESSED)
+
+#define SQFS_MAX_BLOCK_LOG		20
+#define SQFS_MIN_BLOCK_LOG		12
+
+/* Fragment index of a file without a tail end in a fragment block */
+#define SQFS_INVALID_FRAG		0xffffffff
+#define SQFS_FRAGMENTS_PER_BLOCK	\
+	(SQFS_METADATA_SIZE / sizeof(struct sqfs_fragment_entry))
+
+/* Superblock flags */
+#define SQFS_FLAG_COMP_OPTS		BIT(10)
+
+/* Offset in the directory 'file_size' which counts the . and .. entries */
+#define SQFS_DIR_SIZE_OFFSET		3
+
+enum sqfs_compression {
+	SQFS_COMP_ZLIB = 1,
+	SQFS_COMP_LZMA,
+	SQFS_COMP_LZO,
+	SQFS_COMP_XZ,
+	SQFS_COMP_LZ4,
+	SQFS_COMP_ZSTD,
+};
+
+enum sqfs_inode_type {
+	SQFS_DIR_TYPE = 1,
+	SQFS_REG_TYPE,
+	SQFS_SYMLINK_TYPE,
+	SQFS_BLKDEV_TYPE,
+	SQFS_CHRDEV_TYPE,
+	SQFS_FIFO_TYPE,
+	SQFS_SOCKET_TYPE,
+	SQFS_LDIR_TYPE,
+	SQFS_LREG_TYPE,
+	SQFS_LSYMLINK_TYPE,
+	SQFS_LBLKDEV_TYPE,
+	SQFS_LCHRDEV_TYPE,
+	SQFS_LFIFO_TYPE,
+	SQFS_LSOCKET_TYPE,
+};
+
+struct sqfs_super_block {
+	__le32 s_magic;
+	__le32 inodes;
+	__le32 mkfs_time;
+	__le32 block_size;
+	__le32 fragments;
+	__le16 compression;
+	__le16 block_log;
+	__le16 flags;
+	__le16 no_ids;
+	__le16 s_major;
+	__le16 s_minor;
+	__le64 root_inode;
+	__le64 bytes_used;
+	__le64 id_table_start;
+	__le64 xattr_id_table_start;
+	__le64 inode_table_start;
+	__le64 directory_table_start;
+	__le64 fragment_table_start;
+	__le64 export_table_start;
+} __packed;
+
+struct sqfs_base_inode {
+	__le16 inode_type;
+	__le16 mode;
+	__le16 uid;
+	__le16 guid;
+	__le32 mtime;
+	__le32 inode_number;
+} __packed;
+
+struct sqfs_dir_inode {
+	struct sqfs_base_inode base;
+	__le32 start_block;
+	__le32 nlink;
+	__le16 file_size;
+	__le16 offset;
+	__le32 parent_inode;
+} __packed;
+
+struct sqfs_ldir_inode {
+	struct sqfs_base_inode base;
+	__le32 nlink;
+	__le32 file_size;
+	__le32 start_block;
+	__le32 parent_inode;
+	__le16 i_count;
+	__le16 offset;
+	__le32 xattr;
+	/* followed by i_count struct sqfs_dir_index */
+} __packed;
+
+/* Directory index entry, followed by size + 1 bytes of name */
+struct sqfs_dir_index {
+	__le32 index;
+	__le32 start_block;
+	__le32 size;
+} __packed;
+
+struct sqfs_reg_inode {
+	struct sqfs_base_inode base;
+	__le32 start_block;
+	__le32 fragment;
+	__le32 offset;
+	__le32 file_size;
+	/* followed by the block list */
+} __packed;
+
+struct sqfs_lreg_inode {
+	struct sqfs_base_inode base;
+	__le64 start_block;
+	__le64 file_size;
+	__le64 sparse;
+	__le32 nlink;
+	__le32 fragment;
+	__le32 offset;
+	__le32 xattr;
+	/* followed by the block list */
+} __packed;
+
+/* Also used for long symlinks, which add an xattr index after the target */
+struct sqfs_symlink_inode {
+	struct sqfs_base_inode base;
+	__le32 nlink;
+	__le32 symlink_size;
+	/* followed by symlink_size bytes of target, not nul-terminated */
+} __packed;
+
+struct sqfs_dir_header {
+	__le32 count;		/* number of entries minus one */
+	__le32 start_block;
+	__le32 inode_number;
+} __packed;
+
+/* Directory entry, followed by size + 1 bytes of name */
+struct sqfs_dir_entry {
+	__le16 offset;
+	__le16 inode_offset;
+	__le16 type;
+	__le16 size;
+} __packed;
+
+struct sqfs_fragment_entry {
+	__le64 start_block;
+	__le32 size;
+	__le32 unused;
+} __packed;
+
+/* Entries per directory header are limited to this by mksquashfs */
+#define SQFS_DIR_COUNT			256
+
+/**
+ * sqfs_decompress() - Decompress a metadata or data block
+ *
+ * @comp: Compression type of the filesystem (enum sqfs_compression)
+ * @dst: Destination buffer
+ * @dst_len: Size of @dst, returns the number of bytes produced
+ * @src: Compressed data
+ * @src_len: Number of bytes of compressed data
+ * @return 0 if OK, -EPROTONOSUPPORT if @comp is not supported in this build,
+ *	other -ve value on a decompression error
+ */
+int sqfs_decompress(u16 comp, void *dst, size_t *dst_len, const void *src,
+		    size_t src_len);
+
+/**
+ * sqfs_decompressor_supported() - Check whether a compressor can be read
+ *
+ * @comp: Compression type of the filesystem (enum sqfs_compression)
+ * @return true if blocks compressed with @comp can be decompressed
+ */
+bool sqfs_decompressor_supported(u16 comp);
+
+/**
+ * sqfs_decompressor_cleanup() - Free memory held by the decompressors
+ */
+void sqfs_decompressor_cleanup(void);
+
+#endif /* __SQFS_FILESYSTEM_H__ */
@@ -671,23 +671,13 @@ static inline void *kmap(struct page *page)
 	return page->addr;
 }
 
-static int read_block(struct inode *inode, void *addr, unsigned int block,
-		      struct ubifs_data_node *dn)
+static int decompress_block(struct ubifs_info *c, struct inode *inode,
+			    void *addr, unsigned int block,
+			    struct ubifs_data_node *dn)
 {
-	struct ubifs_info *c = inode->i_sb->s_fs_info;
 	int err, len, out_len;
-	union ubifs_key key;
 	unsigned int dlen;
 
-	data_key_init(c, &key, inode->i_ino, block);
-	err = ubifs_tnc_lookup(c, &key, dn);
-	if (err) {
-		if (err == -ENOENT)
-			/* Not found, so it must be a hole */
-			memset(addr, 0, UBIFS_BLOCK_SIZE);
-		return err;
-	}
-
 	ubifs_assert(le64_to_cpu(dn->ch.sqnum) > ubifs_inode(inode)->creat_sqnum);
 
 	len = le32_to_cpu(dn->size);
@@ -718,6 +708,69 @@ dump:
 	return -EINVAL;
 }
 
+static int read_block(struct inode *inode, void *addr, unsigned int block,
+		      struct ubifs_data_node *dn)
+{
+	struct ubifs_info *c = inode->i_sb->s_fs_info;
+	union ubifs_key key;
+	int err;
+
+	data_key_init(c, &key, inode->i_ino, block);
+	err = ubifs_tnc_lookup(c, &key, dn);
+	if (err) {
+		if (err == -ENOENT)
+			/* Not found, so it must be a hole */
+			memset(addr, 0, UBIFS_BLOCK_SIZE);
+		return err;
+	}
+
+	return decompress_block(c, inode, addr, block, dn);
+}
+
+/*
+ * Read up to @max_blocks whole blocks starting at @block into @addr, reading
+ * data nodes that are stored one after the other in a LEB with a single flash
+ * read. Returns the number of blocks read, 0 if there is nothing to gain from
+ * a bulk-read here, or a negative error code.
+ */
+static int bulk_read_blocks(struct ubifs_info *c, struct inode *inode,
+			    struct bu_info *bu, void *addr, unsigned int block,
+			    unsigned int max_blocks)
+{
+	struct ubifs_data_node *dn;
+	unsigned int i, blk_cnt;
+	int err, n = 0;
+
+	data_key_init(c, &bu->key, inode->i_ino, block);
+	err = ubifs_tnc_get_bu_keys(c, bu);
+	if (err)
+		return err;
+	if (bu->cnt < 2)
+		return 0;
+
+	err = ubifs_tnc_bulk_read(c, bu);
+	if (err)
+		return err;
+
+	blk_cnt = min_t(unsigned int, bu->blk_cnt, max_blocks);
+	for (i = 0; i < blk_cnt; i++, addr += UBIFS_BLOCK_SIZE) {
+		if (n < bu->cnt &&
+		    key_block(c, &bu->zbranch[n].key) == block + i) {
+			dn = bu->buf + bu->zbranch[n].offs -
+			     bu->zbranch[0].offs;
+			err = decompress_block(c, inode, addr, block + i, dn);
+			if (err)
+				return err;
+			n++;
+		} else {
+			/* A hole */
+			memset(addr, 0, UBIFS_BLOCK_SIZE);
+		}
+	}
+
+	return blk_cnt;
+}
+
 static int do_readpage(struct ubifs_info *c, struct inode *inode,
 		       struct page *page, int last_block_size)
 {
@@ -836,8 +889,9 @@ int ubifs_read(const char *filename, void *buf, loff_t offset,
 	unsigned long inum;
 	struct inode *inode;
 	struct page page;
+	struct bu_info *bu;
 	int err = 0;
-	int i;
+	int i, n;
 	int count;
 	int last_block_size = 0;
 
@@ -884,22 +938,55 @@ int ubifs_read(const char *filename, void *buf, loff_t offset,
 
 	count = (size + UBIFS_BLOCK_SIZE - 1) >> UBIFS_BLOCK_SHIFT;
 
+	/* Without memory for bulk-reads, just read block by block */
+	bu = kmalloc(sizeof(*bu), GFP_NOFS);
+	if (bu) {
+		bu->buf_len = c->max_bu_buf_len;
+		bu->buf = kmalloc(bu->buf_len, GFP_NOFS);
+		if (!bu->buf) {
+			kfree(bu);
+			bu = NULL;
+		}
+	}
+
 	page.addr = buf;
 	page.index = offset / PAGE_SIZE;
 	page.inode = inode;
-	for (i = 0; i < count; i++) {
+	for (i = 0; i < count; i += n) {
 		/*
-		 * Make sure to not read beyond the requested size
+		 * Bulk-read what we can, except the last block, which must
+		 * not be written beyond the requested size
 		 */
-		if (((i + 1) == count) && (size < inode->i_size))
-			last_block_size = size - (i * PAGE_SIZE);
+		n = 0;
+		if (bu && UBIFS_BLOCKS_PER_PAGE == 1 && i + 1 < count) {
+			n = bulk_read_blocks(c, inode, bu, page.addr,
+					     page.index, count - i - 1);
+			if (n < 0) {
+				err = n;
+				break;
+			}
+		}
 
-		err = do_readpage(c, inode, &page, last_block_size);
-		if (err)
-			break;
+		if (!n) {
+			/*
+			 * Make sure to not read beyond the requested size
+			 */
+			if (((i + 1) == count) && (size < inode->i_size))
+				last_block_size = size - (i * PAGE_SIZE);
+
+			err = do_readpage(c, inode, &page, last_block_size);
+			if (err)
+				break;
+			n = 1;
+		}
+
+		page.addr += n * PAGE_SIZE;
+		page.index += n;
+	}
 
-		page.addr += PAGE_SIZE;
-		page.index++;
+	if (bu) {
+		kfree(bu->buf);
+		kfree(bu);
 	}
 
 	if (err) {
@@ -205,12 +205,33 @@ enum bootstage_id {
 	BOOTSTAGE_ID_ACCUM_FSP_M,
 	BOOTSTAGE_ID_ACCUM_FSP_S,
 	BOOTSTAGE_ID_ACCUM_MMAP_SPI,
+	BOOTSTAGE_ID_ACCUM_UBI,
 
 	/* a few spare for the user, from here */
 	BOOTSTAGE_ID_USER,
 	BOOTSTAGE_ID_ALLOC,
 };
 
+/*
+ * Types of span, used to group related spans in reports. A span is an
+ * interval of time during boot, which may contain other spans.
+ */
+enum bootstage_span_type {
+	BOOTSTAGE_SPAN_USER,		/* Added by board or other code */
+	BOOTSTAGE_SPAN_PROBE,		/* Probing a device */
+	BOOTSTAGE_SPAN_READ,		/* Reading from a block device */
+	BOOTSTAGE_SPAN_DECOMP,		/* Decompressing an image */
+	BOOTSTAGE_SPAN_VERIFY,		/* Verifying the hash of an image */
+
+	BOOTSTAGE_SPAN_TYPE_COUNT,
+};
+
+/* Formats for bootstage_export() */
+enum bootstage_export_fmt {
+	BOOTSTAGE_EXPORT_JSON,
+	BOOTSTAGE_EXPORT_CSV,
+};
+
 /*
  * Return the time since boot in microseconds, This is needed for bootstage
  * and should be defined in CPU- or board-specific code. If undefined then
@@ -310,9 +331,48 @@ uint32_t bootstage_start(enum bootstage_id id, const char *name);
  */
 uint32_t bootstage_accum(enum bootstage_id id);
 
+/**
+ * bootstage_span_begin() - Mark the start of a span of activity
+ *
+ * Spans nest, so a span started before the current one ends is recorded as
+ * part of it. If the last span started in the current span has the same
+ * type and name and has ended, it is reused and its time accumulates, so
+ * that repeated operations such as block reads take up a single entry.
+ *
+ * @type: Type of span (enum bootstage_span_type)
+ * @name: Name of span, e.g. the device name, or NULL if none. This is
+ *	copied and truncated if needed
+ * @return span number to pass to bootstage_span_end(), or -ENOSPC if there
+ *	is no space for another span, -ENOENT if bootstage is not set up
+ */
+int bootstage_span_begin(enum bootstage_span_type type, const char *name);
+
+/**
+ * bootstage_span_end() - Mark the end of a span of activity
+ *
+ * @span: Span number returned by bootstage_span_begin(). Negative values
+ *	are ignored
+ */
+void bootstage_span_end(int span);
+
 /* Print a report about boot time */
 void bootstage_report(void);
 
+/**
+ * bootstage_export() - Write out the bootstage data in a machine-readable form
+ *
+ * This writes the marks, accumulated times and spans, either as a JSON
+ * object or as CSV with a heading line. All times are in microseconds. With
+ * CONFIG_PERF_COUNTERS the performance counters are included too.
+ *
+ * @fmt: Format to use (enum bootstage_export_fmt)
+ * @buf: Buffer to write to, or NULL to write to the console
+ * @size: Size of @buf in bytes
+ * @return number of bytes written (excluding the terminator), or -ENOSPC if
+ *	@buf is too small
+ */
+int bootstage_export(enum bootstage_export_fmt fmt, char *buf, int size);
+
 /**
  * Add bootstage information to the device tree
  *
@@ -409,6 +469,16 @@ static inline uint32_t bootstage_accum(enum bootstage_id id)
 	return 0;
 }
 
+static inline int bootstage_span_begin(enum bootstage_span_type type,
+				       const char *name)
+{
+	return -1;
+}
+
+static inline void bootstage_span_end(int span)
+{
+}
+
 static inline int bootstage_stash(void *base, int size)
 {
 	return 0;	/* Pretend to succeed */
@@ -167,6 +167,7 @@ struct sandbox_sdl_plat {
 	int rot;
 	const char *vidconsole_drv_name;
 	int font_size;
+	bool pan;
 };
 
 /* Declare ping methods for the drivers */
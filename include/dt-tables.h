@@ -0,0 +1,128 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Read-only device-tree tables, generated at build time by dtoc
+ *
+ * These hold the whole device tree as arrays, so that nodes and properties can
+ * be found without parsing the flattened tree with libfdt. Phandles are
+ * resolved to node indexes at build time. See doc/driver-model/of-plat.rst
+ */
+
+#ifndef __DT_TABLES_H
+#define __DT_TABLES_H
+
+#include <linux/types.h>
+
+/* Node index used when there is no node, e.g. the parent of the root node */
+#define DTT_NONE	0xffff
+
+/**
+ * struct dtt_node - a device-tree node
+ *
+ * Nodes are in the same order as in the flattened tree, so the root node is
+ * first and each node's subnodes follow it.
+ *
+ * @name: Offset of the node name in the string table ("" for the root node)
+ * @first_prop: Index of the node's first property in the property table
+ * @phandle: Node's phandle, or 0 if none
+ * @parent: Index of the parent node, or DTT_NONE for the root node
+ * @first_child: Index of the first subnode, or DTT_NONE if none
+ * @next_sibling: Index of the next node with the same parent, or DTT_NONE
+ * @num_props: Number of properties in the node
+ */
+struct dtt_node {
+	u32 name;
+	u32 first_prop;
+	u32 phandle;
+	u16 parent;
+	u16 first_child;
+	u16 next_sibling;
+	u16 num_props;
+};
+
+/**
+ * struct dtt_prop - a device-tree property
+ *
+ * @name: Offset of the property name in the string table
+ * @value: Offset of the value in the value table. This is 4-byte aligned and
+ *	in the same (big-endian) format as in the flattened tree
+ * @len: Length of the value in bytes
+ */
+struct dtt_prop {
+	u32 name;
+	u32 value;
+	u32 len;
+};
+
+/**
+ * struct dtt_phandle - a phandle lookup entry, sorted by phandle
+ *
+ * @phandle: Phandle value
+ * @node: Index of the node with that phandle
+ */
+struct dtt_phandle {
+	u32 phandle;
+	u16 node;
+};
+
+/**
+ * struct dtt_compat - a compatible-string lookup entry
+ *
+ * There is one entry for each string in each enabled node's 'compatible'
+ * property. Entries are sorted by string, then by node index, so that the
+ * nodes a driver can bind to are found with a binary search.
+ *
+ * @compat: Offset of the compatible string in the string table
+ * @node: Index of a node with that compatible string
+ */
+struct dtt_compat {
+	u32 compat;
+	u16 node;
+};
+
+/**
+ * struct dtt_ref - a phandle resolved at build time
+ *
+ * dtoc resolves the phandles in properties such as 'clocks' and '*-gpios'.
+ * Entries are sorted by property index.
+ *
+ * @prop: Index of the property containing the phandle
+ * @cell: Index of the cell holding the phandle, within the property value.
+ *	The phandle's arguments follow it
+ * @node: Index of the node which the phandle refers to
+ */
+struct dtt_ref {
+	u32 prop;
+	u16 cell;
+	u16 node;
+};
+
+/**
+ * struct dtt_tree - the whole device tree as tables
+ *
+ * @strings: Node names, property names and compatible strings, each
+ *	nul-terminated
+ * @values: Property values
+ * @nodes: Nodes, with @num_nodes entries
+ * @props: Properties, indexed by struct dtt_node.first_prop
+ * @phandles: Phandle lookup table, with @num_phandles entries
+ * @compats: Compatible-string lookup table, with @num_compats entries
+ * @refs: Resolved phandles, with @num_refs entries
+ */
+struct dtt_tree {
+	const char *strings;
+	const u8 *values;
+	const struct dtt_node *nodes;
+	const struct dtt_prop *props;
+	const struct dtt_phandle *phandles;
+	const struct dtt_compat *compats;
+	const struct dtt_ref *refs;
+	int num_nodes;
+	int num_phandles;
+	int num_compats;
+	int num_refs;
+};
+
+/* Generated by 'dtoc dt-tables' */
+extern const struct dtt_tree dtt_tree;
+
+#endif
@@ -651,6 +651,19 @@ int fdtdec_get_chosen_node(const void *blob, const char *name);
  */
 const char *fdtdec_get_compatible(enum fdt_compat_id id);
 
+/**
+ * fdtdec_node_offset_by_phandle() - find the node with a given phandle
+ *
+ * This behaves like fdt_node_offset_by_phandle(). For U-Boot's control FDT
+ * it uses an index when CONFIG_OF_PHANDLE_INDEX is enabled, which avoids
+ * scanning the whole tree on every lookup.
+ *
+ * @blob:	FDT blob
+ * @phandle:	phandle value to look up
+ * @return node offset if found, -ve FDT_ERR_... on error
+ */
+int fdtdec_node_offset_by_phandle(const void *blob, uint32_t phandle);
+
 /* Look up a phandle and follow it to its node. Then return the offset
  * of that node.
  *
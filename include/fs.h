@@ -15,6 +15,7 @@ struct cmd_tbl;
 #define FS_TYPE_SANDBOX	3
 #define FS_TYPE_UBIFS	4
 #define FS_TYPE_BTRFS	5
+#define FS_TYPE_SQUASHFS 6
 
 struct blk_desc;
 
@@ -136,6 +137,24 @@ int fs_size(const char *filename, loff_t *size);
 int fs_read(const char *filename, ulong addr, loff_t offset, loff_t len,
 	    loff_t *actread);
 
+/**
+ * fs_read_gunzip() - read and decompress a gzipped file
+ *
+ * This reads the file from the partition previously set by fs_set_blk_dev()
+ * a piece at a time and decompresses each piece as it arrives, so the
+ * compressed file is never held in memory as a whole. The buffer must not
+ * overlap reserved memory.
+ *
+ * @filename:	full path of the gzipped file to read from
+ * @addr:	address of the buffer to decompress into
+ * @maxlen:	size of the buffer. Use 0 to use all the free memory at @addr,
+ *		which needs CONFIG_LMB
+ * @actread:	returns the number of bytes decompressed
+ * Return:	0 if OK, -ve on error
+ */
+int fs_read_gunzip(const char *filename, ulong addr, ulong maxlen,
+		   ulong *actread);
+
 /**
  * fs_write() - write file to the partition previously set by fs_set_blk_dev()
  *
@@ -233,6 +252,8 @@ int do_size(struct cmd_tbl *cmdtp, int flag, int argc, char *const argv[],
 	    int fstype);
 int do_load(struct cmd_tbl *cmdtp, int flag, int argc, char *const argv[],
 	    int fstype);
+int do_gzload(struct cmd_tbl *cmdtp, int flag, int argc, char *const argv[],
+	      int fstype);
 int do_ls(struct cmd_tbl *cmdtp, int flag, int argc, char *const argv[],
 	  int fstype);
 int file_exists(const char *dev_type, const char *dev_part, const char *file,
@@ -31,6 +31,36 @@ int gzip_parse_header(const unsigned char *src, unsigned long len);
  */
 int gunzip(void *dst, int dstlen, unsigned char *src, unsigned long *lenp);
 
+/**
+ * typedef gunzip_read_fn - Supply compressed data to gunzip_stream()
+ *
+ * @priv: Private data passed to gunzip_stream()
+ * @buf: Buffer to fill with the next compressed bytes
+ * @size: Space available in @buf
+ * @return number of bytes placed in @buf, 0 at end of input, -ve on error
+ */
+typedef long (*gunzip_read_fn)(void *priv, void *buf, ulong size);
+
+/**
+ * gunzip_stream() - Decompress gzipped data supplied in chunks
+ *
+ * Unlike gunzip() this does not need the whole compressed image in memory.
+ * Compressed data is fetched from @read in chunks of up to @chunk bytes,
+ * e.g. straight from a file or block device, and inflated as it arrives.
+ * The gzip header may span several chunks. The CRC and length in the gzip
+ * trailer are checked.
+ *
+ * @dst: Destination for uncompressed data
+ * @dstlen: Size of destination buffer
+ * @read: Function to call to obtain the next chunk of compressed data
+ * @priv: Private data to pass to @read
+ * @chunk: Size of the input buffer to use
+ * @lenp: Returns length of uncompressed data
+ * @return 0 if OK, -1 on error
+ */
+int gunzip_stream(void *dst, ulong dstlen, gunzip_read_fn read, void *priv,
+		  ulong chunk, ulong *lenp);
+
 /**
  * zunzip() - Uncompress blocks compressed with zlib without headers
  *
@@ -13,6 +13,7 @@
 #include <linker_lists.h>
 #include <dm/uclass-id.h>
 #include <linux/list.h>
+#include <linux/types.h>
 
 struct cmd_tbl;
 
@@ -435,6 +436,14 @@ int do_log_test(struct cmd_tbl *cmdtp, int flag, int argc, char *const argv[]);
 int log_add_filter(const char *drv_name, enum log_category_t cat_list[],
 		   enum log_level_t max_level, const char *file_list);
 
+/**
+ * log_device_find_by_name() - Look up a log device by its driver name
+ *
+ * @drv_name: Name of the driver (e.g. "console")
+ * @return log device, or NULL if there is no such driver
+ */
+struct log_device *log_device_find_by_name(const char *drv_name);
+
 /**
  * log_remove_filter() - Remove a filter from a log device
  *
@@ -446,6 +455,136 @@ int log_add_filter(const char *drv_name, enum log_category_t cat_list[],
  */
 int log_remove_filter(const char *drv_name, int filter_num);
 
+enum {
+	LOG_BUF_MAGIC		= 0x6c6f6762,	/* 'logb' */
+	LOG_BUF_VERSION		= 1,
+};
+
+/**
+ * struct log_buf_hdr - header of the binary log buffer
+ *
+ * The log buffer holds the most recent log records in binary form. Records
+ * are variable-sized and follow this header, starting at @tail and wrapping
+ * around at the end of the buffer. A record with a size of 0 marks the point
+ * where the records wrap around before the end.
+ *
+ * @magic: LOG_BUF_MAGIC
+ * @version: LOG_BUF_VERSION
+ * @ptr_size: Size of a pointer in a record, in bytes
+ * @size: Size of the record area which follows this header
+ * @head: Offset in the record area where the next record will be written
+ * @tail: Offset in the record area of the oldest record
+ * @count: Number of records in the buffer
+ * @dropped: Number of records which were overwritten or did not fit
+ * @reloc_off: Amount added to the link-time addresses of U-Boot when it was
+ *	relocated. Subtracting this from the format string pointer in a record
+ *	gives its address in the U-Boot ELF file
+ */
+struct log_buf_hdr {
+	u32 magic;
+	u16 version;
+	u16 ptr_size;
+	u32 size;
+	u32 head;
+	u32 tail;
+	u32 count;
+	u32 dropped;
+	u32 reserved;
+	u64 reloc_off;
+};
+
+enum log_buf_rec_flags {
+	LOGBF_TEXT	= 1 << 0,	/* Args hold the formatted message */
+};
+
+/**
+ * struct log_buf_rec - a record in the binary log buffer
+ *
+ * This structure is followed by the file name and the function name, each
+ * nul-terminated, then the arguments of the message in the order given by
+ * the format string. Integers and plain pointers take the size of their type
+ * and are not aligned, strings are copied and nul-terminated. Records using
+ * conversions which cannot be deferred (e.g. '%pM') are formatted when they
+ * are logged and stored with LOGBF_TEXT.
+ *
+ * @size: Size of this record including the arguments, in bytes
+ * @level: Log level (enum log_level_t)
+ * @flags: Record flags (enum log_buf_rec_flags)
+ * @cat: Log category (enum log_category_t)
+ * @line: Line number where the log record was generated
+ * @time_us: Time when the record was generated, in microseconds
+ * @fmt: printf() format string (pointer)
+ */
+struct log_buf_rec {
+	u16 size;
+	u8 level;
+	u8 flags;
+	u16 cat;
+	u16 line;
+	u32 time_us;
+	ulong fmt;
+};
+
+#if CONFIG_IS_ENABLED(LOG_BUF)
+/**
+ * log_buf_init() - Set up the binary log buffer
+ *
+ * The buffer is placed in the bloblist if enabled, else it is allocated
+ *
+ * @return 0 if OK, -ENOMEM if out of memory
+ */
+int log_buf_init(void);
+
+/**
+ * log_buf_add() - Add a record to the binary log buffer
+ *
+ * This stores the format string pointer and the raw arguments, so that the
+ * (relatively expensive) formatting is only done if the record is shown
+ * later. If the buffer is full, the oldest records are dropped.
+ *
+ * @rec: Log record to add (rec->msg is not used)
+ * @fmt: printf() format string for the message. This must not change later
+ * @args: Arguments for @fmt
+ */
+void log_buf_add(struct log_rec *rec, const char *fmt, va_list args);
+
+/**
+ * log_buf_dump() - Show the records in the binary log buffer
+ *
+ * The records are formatted and written using the console log driver, so
+ * the 'log format' setting is respected
+ *
+ * @return 0 if OK, -ENOENT if there is no log buffer
+ */
+int log_buf_dump(void);
+
+/**
+ * log_buf_fdt_fixup() - Tell the OS where the binary log buffer is
+ *
+ * This reserves the buffer in the device tree and adds its address and size
+ * to the /chosen/u-boot,log-buf property
+ *
+ * @blob: Device tree to update
+ * @return 0 if OK, -ve on error
+ */
+int log_buf_fdt_fixup(void *blob);
+#else
+static inline int log_buf_init(void)
+{
+	return 0;
+}
+
+static inline void log_buf_add(struct log_rec *rec, const char *fmt,
+			       va_list args)
+{
+}
+
+static inline int log_buf_fdt_fixup(void *blob)
+{
+	return 0;
+}
+#endif
+
 #if CONFIG_IS_ENABLED(LOG)
 /**
  * log_init() - Set up the log system ready for use
@@ -9,6 +9,10 @@
 /**
  * ulz4fn() - Decompress LZ4 data
  *
+ * The data may consist of several concatenated LZ4 frames, optionally
+ * interleaved with skippable frames, which are decoded one after another.
+ * Data following the last frame is ignored.
+ *
  * @src: Source data to decompress
  * @srcn: Length of source data
  * @dst: Destination for uncompressed data
@@ -21,4 +25,19 @@
  */
 int ulz4fn(const void *src, size_t srcn, void *dst, size_t *dstn);
 
+/**
+ * ulz4_block() - Decompress a single raw LZ4 block
+ *
+ * This is for users which store LZ4 blocks without the frame format around
+ * them, such as SquashFS.
+ *
+ * @src: Source data to decompress
+ * @srcn: Length of source data
+ * @dst: Destination for uncompressed data
+ * @dstn: Size of the destination buffer, returns length of uncompressed data
+ * @return 0 if OK, -EPROTO if the compressed data is invalid or does not fit
+ *	into the destination buffer
+ */
+int ulz4_block(const void *src, size_t srcn, void *dst, size_t *dstn);
+
 #endif
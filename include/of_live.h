@@ -11,6 +11,36 @@
 
 struct device_node;
 
+/**
+ * unflatten_device_tree() - create tree of device_nodes from flat blob
+ *
+ * unflattens a device-tree, creating the
+ * tree of struct device_node. It also fills the "name" and "type"
+ * pointers of the nodes so the normal device-tree walking functions
+ * can be used.
+ *
+ * The tree is held in a single allocation, starting with the root node, so
+ * it can be freed with free(*mynodes).
+ *
+ * @blob: The blob to expand
+ * @mynodes: The device_node tree created by the call
+ * @return 0 if OK, -ve on error
+ */
+int unflatten_device_tree(const void *blob, struct device_node **mynodes);
+
+/**
+ * unflatten_device_tree_size() - find the space needed to unflatten a blob
+ *
+ * This walks the tags of the blob once, without building anything, to find
+ * an upper bound for the size of the tree created by unflatten_device_tree().
+ * If this returns 0, unflatten_device_tree() sizes the tree with a slower
+ * pass over its nodes instead.
+ *
+ * @blob: The blob to expand
+ * @return number of bytes needed, or 0 if the blob is too deep or invalid
+ */
+unsigned long unflatten_device_tree_size(const void *blob);
+
 /**
  * of_live_build() - build a live (hierarchical) tree from a flat DT
  *
@@ -0,0 +1,133 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Hot-path performance counters
+ *
+ * These count the I/O and memory-allocation work done by U-Boot, so that it
+ * is possible to see where the time goes when loading an OS, e.g. whether a
+ * slow boot is due to many small block reads or to a slow driver.
+ *
+ * When CONFIG_PERF_COUNTERS is not enabled, the hooks are empty inline
+ * functions and the compiler drops them entirely.
+ */
+
+#ifndef __PERF_COUNTER_H
+#define __PERF_COUNTER_H
+
+#include <linux/types.h>
+
+/* Subsystems which have counters */
+enum perf_subsys {
+	PERF_BLK,
+	PERF_ETH,
+	PERF_MTD,
+	PERF_MALLOC,
+
+	PERF_SUBSYS_COUNT,
+};
+
+/*
+ * Counters kept for each subsystem. Not every subsystem uses every counter;
+ * see perf_get_counter_name() for the ones that are shown.
+ */
+enum perf_counter {
+	PERF_CNT_READS,		/* Read requests, received packets, allocs */
+	PERF_CNT_READ_BYTES,	/* Bytes read, received or allocated */
+	PERF_CNT_WRITES,	/* Write requests, sent packets, frees */
+	PERF_CNT_WRITE_BYTES,	/* Bytes written or sent */
+	PERF_CNT_ERASES,	/* Erase requests */
+	PERF_CNT_TIME_US,	/* Time spent in the driver, in microseconds */
+	PERF_CNT_CACHE_HITS,	/* Reads satisfied from a cache */
+	PERF_CNT_ERRORS,	/* Failed requests */
+
+	PERF_CNT_COUNT,
+};
+
+#if CONFIG_IS_ENABLED(PERF_COUNTERS)
+/**
+ * perf_add() - Add to a counter
+ *
+ * This does nothing before relocation, since the counters are in BSS.
+ *
+ * @sys: Subsystem to update
+ * @cnt: Counter to update
+ * @val: Value to add
+ */
+void perf_add(enum perf_subsys sys, enum perf_counter cnt, ulong val);
+
+/**
+ * perf_time_start() - Start timing a driver operation
+ *
+ * @return start time to pass to perf_time_end()
+ */
+ulong perf_time_start(void);
+
+/**
+ * perf_time_end() - Finish timing a driver operation
+ *
+ * This adds the time since perf_time_start() to the PERF_CNT_TIME_US counter
+ *
+ * @sys: Subsystem which did the operation
+ * @start: Value returned by perf_time_start()
+ */
+void perf_time_end(enum perf_subsys sys, ulong start);
+#else
+static inline void perf_add(enum perf_subsys sys, enum perf_counter cnt,
+			    ulong val)
+{
+}
+
+static inline ulong perf_time_start(void)
+{
+	return 0;
+}
+
+static inline void perf_time_end(enum perf_subsys sys, ulong start)
+{
+}
+#endif
+
+/*
+ * The functions below are only available with CONFIG_PERF_COUNTERS, so
+ * callers must check CONFIG_IS_ENABLED(PERF_COUNTERS) first
+ */
+
+/**
+ * perf_get() - Read a counter
+ *
+ * @sys: Subsystem to read
+ * @cnt: Counter to read
+ * @return counter value
+ */
+u64 perf_get(enum perf_subsys sys, enum perf_counter cnt);
+
+/**
+ * perf_get_subsys_name() - Get the name of a subsystem
+ *
+ * @sys: Subsystem to check
+ * @return name, e.g. "blk"
+ */
+const char *perf_get_subsys_name(enum perf_subsys sys);
+
+/**
+ * perf_get_counter_name() - Get the name of a subsystem's counter
+ *
+ * @sys: Subsystem to check
+ * @cnt: Counter to check
+ * @return name, e.g. "read_bytes", or NULL if the subsystem does not use it
+ */
+const char *perf_get_counter_name(enum perf_subsys sys,
+				  enum perf_counter cnt);
+
+/**
+ * perf_show() - Show all counters on the console
+ *
+ * Subsystems which have not counted anything are omitted.
+ */
+void perf_show(void);
+
+/**
+ * perf_reset() - Set all counters to zero
+ */
+void perf_reset(void);
+
+#endif
@@ -28,6 +28,7 @@ enum {
 enum trace_chunk_type {
 	TRACE_CHUNK_FUNCS,
 	TRACE_CHUNK_CALLS,
+	TRACE_CHUNK_RING,
 };
 
 /* A trace record for a function, as written to the profile output file */
@@ -70,15 +71,75 @@ enum ftrace_flags {
 
 #define TRACE_CALL_TYPE(call)	((call)->flags & 0xc0000000UL)
 
-/* Information about a single function entry/exit */
+/*
+ * Information about a single function entry/exit, as written in
+ * TRACE_CHUNK_CALLS chunks by older versions of U-Boot
+ */
 struct trace_call {
 	uint32_t func;		/* Function offset */
 	uint32_t caller;	/* Caller function offset */
 	uint32_t flags;		/* Flags and timestamp */
 };
 
+/*
+ * Header of a TRACE_CHUNK_RING chunk, which holds the function call trace in
+ * the compact form kept in the trace buffer. The rec_count of the chunk is
+ * the number of bytes of call records following this header.
+ *
+ * Each record starts with a ULEB128 value of (delta << 1 | exit), where
+ * delta is the number of microseconds since the previous record. A function
+ * entry is followed by a ULEB128 value giving the function offset divided by
+ * FUNC_SITE_SIZE. A function exit has no further data since it always
+ * belongs to the innermost function which has not yet exited.
+ */
+struct trace_ring_hdr {
+	uint64_t base_time;	/* Time before the first record, in us */
+	uint64_t dropped;	/* Number of older records overwritten */
+	uint32_t text_base;	/* CONFIG_SYS_TEXT_BASE */
+	uint32_t reserved;
+};
+
+/* Maximum size of a record in the call trace */
+#define TRACE_RING_REC_MAX	20
+
+/**
+ * trace_list_calls() - Dump the function call trace into a buffer
+ *
+ * This writes a TRACE_CHUNK_RING chunk with the oldest records first.
+ *
+ * @buff:	Buffer in which to place data, or NULL to count size
+ * @buff_size:	Size of buffer
+ * @needed:	Returns number of bytes used / needed
+ * Return:	0 if ok, -ENOSPC if the buffer is too small
+ */
 int trace_list_calls(void *buff, size_t buff_size, size_t *needed);
 
+/**
+ * trace_set_depth_limit() - Set the maximum call depth to record
+ *
+ * Calls nested more deeply than this are still counted, but are not added
+ * to the call trace.
+ *
+ * @limit:	Maximum depth to record
+ */
+void trace_set_depth_limit(int limit);
+
+/**
+ * trace_set_filter() - Select which functions are added to the call trace
+ *
+ * All functions are recorded by default. Functions which are filtered out
+ * are still counted, but calls to them are not added to the call trace,
+ * which leaves more room for the calls of interest.
+ *
+ * @start:	Offset of first function to change, from the start of U-Boot
+ *		(as used in the trace output)
+ * @size:	Number of bytes of code to change
+ * @include:	true to record calls to these functions, false to drop them
+ * Return:	0 if ok, -EINVAL if the range is outside U-Boot, -ENOENT if
+ *		trace is not set up
+ */
+int trace_set_filter(ulong start, ulong size, bool include);
+
 /**
  * Turn function tracing on and off
  *
@@ -1002,6 +1002,12 @@ typedef enum {
 /* TRB buffer pointers can't cross 64KB boundaries */
 #define TRB_MAX_BUFF_SHIFT	16
 #define TRB_MAX_BUFF_SIZE	(1 << TRB_MAX_BUFF_SHIFT)
+/* Number of segments in a bulk endpoint transfer ring */
+#ifdef CONFIG_USB_XHCI_BULK_RING_SEGS
+#define XHCI_BULK_RING_SEGS	CONFIG_USB_XHCI_BULK_RING_SEGS
+#else
+#define XHCI_BULK_RING_SEGS	1
+#endif
 
 struct xhci_segment {
 	union xhci_trb		*trbs;
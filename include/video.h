@@ -61,7 +61,12 @@ enum video_log2_bpp {
  * @vidconsole_drv_name:	Driver to use for the text console, NULL to
  *		select automatically
  * @font_size:	Font size in pixels (0 to use a default value)
- * @fb:		Frame buffer
+ * @pan_lines:	Number of lines of frame-buffer memory after the display
+ *		which can be shown by panning, using the set_start() method.
+ *		0 if the display cannot pan
+ * @fb:		Frame buffer. This is the first displayed line, which is
+ *		after @fb_base if the display has been panned
+ * @fb_base:	Start of the frame-buffer memory
  * @fb_size:	Frame buffer size
  * @line_length:	Length of each frame buffer line, in bytes. This can be
  *		set by the driver, but if not, the uclass will set it after
@@ -73,6 +78,9 @@ enum video_log2_bpp {
  * @cmap:	Colour map for 8-bit-per-pixel displays
  * @fg_col_idx:	Foreground color code (bit 3 = bold, bit 0-2 = color)
  * @bg_col_idx:	Background color code (bit 3 = bold, bit 0-2 = color)
+ * @damage_ystart:	First frame-buffer line changed since the last sync
+ * @damage_yend:	Line after the last one changed since the last sync. If
+ *		this is not greater than @damage_ystart, nothing has changed
  */
 struct video_priv {
 	/* Things set up by the driver: */
@@ -82,12 +90,14 @@ struct video_priv {
 	enum video_log2_bpp bpix;
 	const char *vidconsole_drv_name;
 	int font_size;
+	int pan_lines;
 
 	/*
 	 * Things that are private to the uclass: don't use these in the
 	 * driver
 	 */
 	void *fb;
+	void *fb_base;
 	int fb_size;
 	int line_length;
 	u32 colour_fg;
@@ -96,10 +106,24 @@ struct video_priv {
 	ushort *cmap;
 	u8 fg_col_idx;
 	u8 bg_col_idx;
+	int damage_ystart;
+	int damage_yend;
 };
 
-/* Placeholder - there are no video operations at present */
+/* Operations which a video driver can optionally provide */
 struct video_ops {
+	/**
+	 * set_start() - Set the start of the displayed part of the frame buffer
+	 *
+	 * This is used to scroll the display without copying it. It is only
+	 * called if the driver sets video_priv->pan_lines
+	 *
+	 * @dev:	Video device
+	 * @offset:	Offset in bytes of the first displayed line from the
+	 *		start of the frame-buffer memory
+	 * @return 0 if OK, -ve on error
+	 */
+	int (*set_start)(struct udevice *dev, ulong offset);
 };
 
 #define video_get_ops(dev)        ((struct video_ops *)(dev)->driver->ops)
@@ -130,12 +154,61 @@ int video_reserve(ulong *addrp);
  */
 int video_clear(struct udevice *dev);
 
+/**
+ * video_move_lines() - Move lines within the frame buffer
+ *
+ * This moves @count lines starting at line @ysrc to line @ydst. When moving
+ * lines up to the top of a display which can pan, this pans the display
+ * instead of copying the lines. In that case the lines below the moved ones
+ * are set to the background colour.
+ *
+ * @vid:	Video device
+ * @ydst:	Line to move to
+ * @ysrc:	Line to move from
+ * @count:	Number of lines to move
+ * @return 0 if OK, -ve on error
+ */
+int video_move_lines(struct udevice *vid, int ydst, int ysrc, int count);
+
+/**
+ * video_unpan() - Show the display from the start of the frame buffer again
+ *
+ * If the display has been panned, this copies it back to the start of the
+ * frame-buffer memory, which is where an OS or EFI application expects it.
+ * The display is not panned after this, so it stays there.
+ *
+ * @dev:	Video device
+ * @return 0 if OK, -ve on error
+ */
+int video_unpan(struct udevice *dev);
+
+/**
+ * video_unpan_all() - Show all displays from the start of their frame buffers
+ *
+ * This calls video_unpan() on all active video devices.
+ */
+void video_unpan_all(void);
+
+/**
+ * video_damage() - Record that some frame-buffer lines have changed
+ *
+ * video_sync() only syncs the lines recorded here. Code which writes to the
+ * frame buffer without calling this function must use video_sync_all()
+ * instead, which syncs the whole frame buffer.
+ *
+ * @vid:	Device to update
+ * @y:		First line which changed
+ * @height:	Number of lines which changed
+ */
+void video_damage(struct udevice *vid, int y, int height);
+
 /**
  * video_sync() - Sync a device's frame buffer with its hardware
  *
  * Some frame buffers are cached or have a secondary frame buffer. This
  * function syncs these up so that the current contents of the U-Boot frame
- * buffer are displayed to the user.
+ * buffer are displayed to the user. Only the lines recorded with
+ * video_damage() since the last sync are updated.
  *
  * @dev:	Device to sync
  * @force:	True to force a sync even if there was one recently (this is
@@ -146,7 +219,8 @@ void video_sync(struct udevice *vid, bool force);
 /**
  * video_sync_all() - Sync all devices' frame buffers with there hardware
  *
- * This calls video_sync() on all active video devices.
+ * This calls video_sync() on all active video devices, syncing the whole of
+ * each frame buffer.
  */
 void video_sync_all(void);
 
@@ -446,6 +446,9 @@ efi_status_t efi_gop_register(void)
 		return EFI_SUCCESS;
 	}
 
+	/* The GOP frame buffer is the start of the memory */
+	if (video_unpan(vdev))
+		return EFI_DEVICE_ERROR;
 	priv = dev_get_uclass_priv(vdev);
 	bpix = priv->bpix;
 	col = video_get_xsize(vdev);
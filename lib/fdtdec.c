@@ -21,6 +21,7 @@
 #include <mapmem.h>
 #include <linux/libfdt.h>
 #include <serial.h>
+#include <sort.h>
 #include <asm/sections.h>
 #include <linux/ctype.h>
 #include <linux/lzo.h>
@@ -586,6 +587,146 @@ int fdtdec_prepare_fdt(void)
 	return 0;
 }
 
+#if CONFIG_IS_ENABLED(OF_PHANDLE_INDEX)
+/**
+ * struct fdtdec_phandle_entry - an entry in the phandle index
+ *
+ * @phandle:	phandle value
+ * @offset:	offset of the node holding the phandle
+ */
+struct fdtdec_phandle_entry {
+	u32 phandle;
+	int offset;
+};
+
+/**
+ * struct fdtdec_phandle_index - sorted phandle index of the control FDT
+ *
+ * @blob:	blob the index was built for, or NULL if none
+ * @count:	number of entries
+ * @entries:	entries, sorted by phandle
+ */
+static struct fdtdec_phandle_index {
+	const void *blob;
+	int count;
+	struct fdtdec_phandle_entry *entries;
+} phandle_index;
+
+static int phandle_entry_cmp(const void *a, const void *b)
+{
+	const struct fdtdec_phandle_entry *ea = a, *eb = b;
+
+	if (ea->phandle == eb->phandle)
+		return 0;
+
+	return ea->phandle < eb->phandle ? -1 : 1;
+}
+
+static void phandle_index_free(void)
+{
+	free(phandle_index.entries);
+	phandle_index.entries = NULL;
+	phandle_index.count = 0;
+	phandle_index.blob = NULL;
+}
+
+static int phandle_index_build(const void *blob)
+{
+	struct fdtdec_phandle_entry *entries;
+	int offset, count = 0;
+
+	phandle_index_free();
+	for (offset = fdt_next_node(blob, -1, NULL); offset >= 0;
+	     offset = fdt_next_node(blob, offset, NULL)) {
+		u32 phandle = fdt_get_phandle(blob, offset);
+
+		if (phandle && phandle != -1)
+			count++;
+	}
+	if (!count)
+		return -FDT_ERR_NOTFOUND;
+
+	entries = malloc(count * sizeof(*entries));
+	if (!entries)
+		return -FDT_ERR_NOSPACE;
+
+	count = 0;
+	for (offset = fdt_next_node(blob, -1, NULL); offset >= 0;
+	     offset = fdt_next_node(blob, offset, NULL)) {
+		u32 phandle = fdt_get_phandle(blob, offset);
+
+		if (phandle && phandle != -1) {
+			entries[count].phandle = phandle;
+			entries[count].offset = offset;
+			count++;
+		}
+	}
+	qsort(entries, count, sizeof(*entries), phandle_entry_cmp);
+
+	phandle_index.blob = blob;
+	phandle_index.count = count;
+	phandle_index.entries = entries;
+	debug("%s: indexed %d phandles\n", __func__, count);
+
+	return 0;
+}
+
+static int phandle_index_lookup(u32 phandle)
+{
+	int low = 0, high = phandle_index.count - 1;
+
+	while (low <= high) {
+		int mid = low + (high - low) / 2;
+		u32 val = phandle_index.entries[mid].phandle;
+
+		if (val == phandle)
+			return phandle_index.entries[mid].offset;
+		if (val < phandle)
+			low = mid + 1;
+		else
+			high = mid - 1;
+	}
+
+	return -FDT_ERR_NOTFOUND;
+}
+
+int fdtdec_node_offset_by_phandle(const void *blob, uint32_t phandle)
+{
+	int offset;
+
+	/* Only the control FDT is indexed, and only once malloc() is ready */
+	if (blob != gd->fdt_blob || !(gd->flags & GD_FLG_RELOC) ||
+	    !phandle || phandle == -1)
+		return fdt_node_offset_by_phandle(blob, phandle);
+
+	if (phandle_index.blob != blob && phandle_index_build(blob))
+		return fdt_node_offset_by_phandle(blob, phandle);
+
+	offset = phandle_index_lookup(phandle);
+	if (offset >= 0 && fdt_get_phandle(blob, offset) != phandle) {
+		/* The tree has changed under us, so start again */
+		debug("%s: stale index, rebuilding\n", __func__);
+		if (phandle_index_build(blob))
+			return fdt_node_offset_by_phandle(blob, phandle);
+		offset = phandle_index_lookup(phandle);
+	}
+
+	/*
+	 * A miss may be a node added since the index was built, so fall back
+	 * to scanning the tree
+	 */
+	if (offset < 0)
+		offset = fdt_node_offset_by_phandle(blob, phandle);
+
+	return offset;
+}
+#else
+int fdtdec_node_offset_by_phandle(const void *blob, uint32_t phandle)
+{
+	return fdt_node_offset_by_phandle(blob, phandle);
+}
+#endif
+
 int fdtdec_lookup_phandle(const void *blob, int node, const char *prop_name)
 {
 	const u32 *phandle;
@@ -596,7 +737,7 @@ int fdtdec_lookup_phandle(const void *blob, int node, const char *prop_name)
 	if (!phandle)
 		return -FDT_ERR_NOTFOUND;
 
-	lookup = fdt_node_offset_by_phandle(blob, fdt32_to_cpu(*phandle));
+	lookup = fdtdec_node_offset_by_phandle(blob, fdt32_to_cpu(*phandle));
 	return lookup;
 }
 
@@ -727,8 +868,8 @@ int fdtdec_parse_phandle_with_args(const void *blob, int src_node,
 			 * below.
 			 */
 			if (cells_name || cur_index == index) {
-				node = fdt_node_offset_by_phandle(blob,
-								  phandle);
+				node = fdtdec_node_offset_by_phandle(blob,
+								     phandle);
 				if (!node) {
 					debug("%s: could not find phandle\n",
 					      fdt_get_name(blob, src_node,
@@ -82,6 +82,87 @@ int gunzip(void *dst, int dstlen, unsigned char *src, unsigned long *lenp)
 	return zunzip(dst, dstlen, src, lenp, 1, offset);
 }
 
+/* Fill @buf as far as possible, since readers may return short counts */
+static long gunzip_stream_fill(gunzip_read_fn read, void *priv,
+			       unsigned char *buf, ulong size)
+{
+	ulong done = 0;
+
+	while (done < size) {
+		long ret = read(priv, buf + done, size - done);
+
+		if (ret < 0)
+			return ret;
+		if (!ret)
+			break;
+		done += ret;
+	}
+
+	return done;
+}
+
+int gunzip_stream(void *dst, ulong dstlen, gunzip_read_fn read, void *priv,
+		  ulong chunk, ulong *lenp)
+{
+	unsigned char *buf;
+	z_stream s;
+	long len;
+	int r;
+	int err = -1;
+
+	buf = malloc_cache_aligned(chunk);
+	if (!buf)
+		return -1;
+
+	/*
+	 * Let zlib parse the gzip header and trailer, so that the header can
+	 * be split across chunks and the CRC and length are checked
+	 */
+	s.zalloc = gzalloc;
+	s.zfree = gzfree;
+	r = inflateInit2(&s, 16 + MAX_WBITS);
+	if (r != Z_OK) {
+		printf("Error: inflateInit2() returned %d\n", r);
+		goto out_free;
+	}
+	s.next_in = buf;
+	s.avail_in = 0;
+	s.next_out = dst;
+	s.avail_out = dstlen;
+
+	do {
+		if (!s.avail_in) {
+			len = gunzip_stream_fill(read, priv, buf, chunk);
+			if (len <= 0) {
+				puts("Error: gunzip out of data\n");
+				break;
+			}
+			s.next_in = buf;
+			s.avail_in = len;
+		}
+		r = inflate(&s, Z_NO_FLUSH);
+		if (r == Z_BUF_ERROR && !s.avail_out) {
+			puts("Error: gunzip output buffer too small\n");
+			break;
+		}
+		if (r != Z_OK && r != Z_STREAM_END) {
+			printf("Error: inflate() returned %d (%s)\n", r,
+			       s.msg ? s.msg : "no message");
+			break;
+		}
+		WATCHDOG_RESET();
+	} while (r != Z_STREAM_END);
+
+	if (r == Z_STREAM_END)
+		err = 0;
+	*lenp = s.next_out - (unsigned char *)dst;
+	inflateEnd(&s);
+out_free:
+	free(buf);
+
+	return err;
+}
+
 #ifdef CONFIG_CMD_UNZIP
 __weak
 void gzwrite_progress_init(u64 expectedsize)
@@ -62,14 +62,33 @@ struct lz4_block_header {
 	/* + u32 block_checksum iff has_block_checksum is set */
 } __packed;
 
-int ulz4fn(const void *src, size_t srcn, void *dst, size_t *dstn)
+/* Skippable frames carry no data for us, e.g. a frame index */
+#define LZ4F_SKIPPABLE_MAGIC		0x184D2A50
+#define LZ4F_SKIPPABLE_MAGIC_MASK	0xfffffff0
+
+static bool lz4_is_skippable(u32 magic)
+{
+	return (magic & LZ4F_SKIPPABLE_MAGIC_MASK) == LZ4F_SKIPPABLE_MAGIC;
+}
+
+/**
+ * ulz4fn_frame() - Decompress a single LZ4 frame
+ *
+ * @src: Start of the frame
+ * @srcn: Number of source bytes available from @src
+ * @dst: Destination for uncompressed data
+ * @end: End of the destination buffer
+ * @used: Returns the number of source bytes making up the frame
+ * @dstn: Returns length of uncompressed data
+ * @return 0 if OK, -ve error as for ulz4fn()
+ */
+static int ulz4fn_frame(const void *src, size_t srcn, void *dst,
+			const void *end, size_t *used, size_t *dstn)
 {
-	const void *end = dst + *dstn;
 	const void *in = src;
 	void *out = dst;
-	int has_block_checksum;
+	int has_block_checksum, has_content_checksum;
 	int ret;
-	*dstn = 0;
 
 	{ /* With in-place decompression the header may become invalid later. */
 		const struct lz4_frame_header *h = in;
@@ -77,7 +96,6 @@ int ulz4fn(const void *src, size_t srcn, void *dst, size_t *dstn)
 		if (srcn < sizeof(*h) + sizeof(u64) + sizeof(u8))
 			return -EINVAL;	/* input overrun */
 
-		/* We assume there's always only a single, standard frame. */
 		if (le32_to_cpu(h->magic) != LZ4F_MAGIC || h->version != 1)
 			return -EPROTONOSUPPORT;	/* unknown format */
 		if (h->reserved0 || h->reserved1 || h->reserved2)
@@ -85,6 +103,7 @@ int ulz4fn(const void *src, size_t srcn, void *dst, size_t *dstn)
 		if (!h->independent_blocks)
 			return -EPROTONOSUPPORT; /* we can't support this yet */
 		has_block_checksum = h->has_block_checksum;
+		has_content_checksum = h->has_content_checksum;
 
 		in += sizeof(*h);
 		if (h->has_content_size)
@@ -104,7 +123,12 @@ int ulz4fn(const void *src, size_t srcn, void *dst, size_t *dstn)
 		}
 
 		if (!b.size) {
-			ret = 0;	/* decompression successful */
+			if (has_content_checksum)
+				in += sizeof(u32);
+			if (in - src > srcn)
+				ret = -EINVAL;	/* input overrun */
+			else
+				ret = 0;	/* decompression successful */
 			break;
 		}
 
@@ -133,6 +157,72 @@ int ulz4fn(const void *src, size_t srcn, void *dst, size_t *dstn)
 			in += sizeof(u32);
 	}
 
+	*used = in - src;
 	*dstn = out - dst;
 	return ret;
 }
+
+int ulz4fn(const void *src, size_t srcn, void *dst, size_t *dstn)
+{
+	const void *end = dst + *dstn;
+	const void *in = src;
+	void *out = dst;
+	bool found = false;
+	int ret = 0;
+
+	*dstn = 0;
+
+	/*
+	 * Large images are often made of several concatenated frames, which
+	 * may be interleaved with skippable frames. Decode them in turn and
+	 * stop at the end of the input or at anything that is not a frame,
+	 * e.g. padding after the last one.
+	 */
+	while (in - src + sizeof(u32) <= srcn) {
+		size_t left = srcn - (in - src);
+		u32 magic = le32_to_cpu(*(u32 *)in);
+		size_t used, size;
+
+		if (lz4_is_skippable(magic)) {
+			if (left < 2 * sizeof(u32))
+				return -EINVAL;	/* input overrun */
+			used = 2 * sizeof(u32) +
+				le32_to_cpu(*(u32 *)(in + sizeof(u32)));
+			if (used > left)
+				return -EINVAL;	/* input overrun */
+			in += used;
+			continue;
+		}
+
+		/* Anything but a frame is fine once we have decoded one */
+		if (found && magic != LZ4F_MAGIC)
+			break;
+
+		ret = ulz4fn_frame(in, left, out, end, &used, &size);
+		out += size;
+		*dstn = out - dst;
+		if (ret)
+			return ret;
+		in += used;
+		found = true;
+	}
+
+	if (!found)
+		return -EPROTONOSUPPORT;	/* unknown format */
+
+	return ret;
+}
+
+int ulz4_block(const void *src, size_t srcn, void *dst, size_t *dstn)
+{
+	int ret;
+
+	/* constant folding essential, do not touch params! */
+	ret = LZ4_decompress_generic(src, dst, srcn, *dstn, endOnInputSize,
+				     full, 0, noDict, dst, NULL, 0);
+	if (ret < 0)
+		return -EPROTO;		/* decompression error */
+
+	*dstn = ret;
+	return 0;
+}
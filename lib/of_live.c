@@ -16,7 +16,7 @@
 #include <dm/of_access.h>
 #include <linux/err.h>
 
-static void *unflatten_dt_alloc(void **mem, unsigned long size,
+static void *unflatten_dt_alloc(void **mem, void *mem_end, unsigned long size,
 				unsigned long align)
 {
 	void *res;
@@ -24,6 +24,8 @@ static void *unflatten_dt_alloc(void **mem, unsigned long size,
 	*mem = PTR_ALIGN(*mem, align);
 	res = *mem;
 	*mem += size;
+	if (mem_end && *mem > mem_end)
+		return NULL;
 
 	return res;
 }
@@ -32,6 +34,8 @@ static void *unflatten_dt_alloc(void **mem, unsigned long size,
  * unflatten_dt_node() - Alloc and populate a device_node from the flat tree
  * @blob: The parent device tree blob
  * @mem: Memory chunk to use for allocating device nodes and properties
+ * @mem_end: End of the memory chunk, or NULL if unbounded. If the chunk is too
+ * small, NULL is returned
  * @poffset: pointer to node in flat tree
  * @dad: Parent struct device_node
  * @nodepp: The device_node tree created by the call
@@ -39,8 +43,8 @@ static void *unflatten_dt_alloc(void **mem, unsigned long size,
  * @dryrun: If true, do not allocate device nodes but still calculate needed
  * memory size
  */
-static void *unflatten_dt_node(const void *blob, void *mem, int *poffset,
-			       struct device_node *dad,
+static void *unflatten_dt_node(const void *blob, void *mem, void *mem_end,
+			       int *poffset, struct device_node *dad,
 			       struct device_node **nodepp,
 			       unsigned long fpsize, bool dryrun)
 {
@@ -56,6 +60,10 @@ static void *unflatten_dt_node(const void *blob, void *mem, int *poffset,
 	int has_name = 0;
 	int new_format = 0;
 
+	/* An earlier aborted pass may have left the depth behind */
+	if (!*poffset)
+		depth = 0;
+
 	pathp = fdt_get_name(blob, *poffset, &l);
 	if (!pathp)
 		return mem;
@@ -91,8 +99,11 @@ static void *unflatten_dt_node(const void *blob, void *mem, int *poffset,
 		}
 	}
 
-	np = unflatten_dt_alloc(&mem, sizeof(struct device_node) + allocl,
+	np = unflatten_dt_alloc(&mem, mem_end,
+				sizeof(struct device_node) + allocl,
 				__alignof__(struct device_node));
+	if (!dryrun && !np)
+		return NULL;
 	if (!dryrun) {
 		char *fn;
 
@@ -141,8 +152,10 @@ static void *unflatten_dt_node(const void *blob, void *mem, int *poffset,
 		}
 		if (strcmp(pname, "name") == 0)
 			has_name = 1;
-		pp = unflatten_dt_alloc(&mem, sizeof(struct property),
+		pp = unflatten_dt_alloc(&mem, mem_end, sizeof(struct property),
 					__alignof__(struct property));
+		if (!dryrun && !pp)
+			return NULL;
 		if (!dryrun) {
 			/*
 			 * We accept flattened tree phandles either in
@@ -186,8 +199,11 @@ static void *unflatten_dt_node(const void *blob, void *mem, int *poffset,
 		if (pa < ps)
 			pa = p1;
 		sz = (pa - ps) + 1;
-		pp = unflatten_dt_alloc(&mem, sizeof(struct property) + sz,
+		pp = unflatten_dt_alloc(&mem, mem_end,
+					sizeof(struct property) + sz,
 					__alignof__(struct property));
+		if (!dryrun && !pp)
+			return NULL;
 		if (!dryrun) {
 			pp->name = "name";
 			pp->length = sz;
@@ -215,7 +231,7 @@ static void *unflatten_dt_node(const void *blob, void *mem, int *poffset,
 	if (depth < 0)
 		depth = 0;
 	while (*poffset > 0 && depth > old_depth) {
-		mem = unflatten_dt_node(blob, mem, poffset, np, NULL,
+		mem = unflatten_dt_node(blob, mem, mem_end, poffset, np, NULL,
 					fpsize, dryrun);
 		if (!mem)
 			return NULL;
@@ -248,19 +264,57 @@ static void *unflatten_dt_node(const void *blob, void *mem, int *poffset,
 	return mem;
 }
 
-/**
- * unflatten_device_tree() - create tree of device_nodes from flat blob
- *
- * unflattens a device-tree, creating the
- * tree of struct device_node. It also fills the "name" and "type"
- * pointers of the nodes so the normal device-tree walking functions
- * can be used.
- * @blob: The blob to expand
- * @mynodes: The device_node tree created by the call
- * @return 0 if OK, -ve on error
- */
-static int unflatten_device_tree(const void *blob,
-				 struct device_node **mynodes)
+/* Deepest tree which unflatten_device_tree_size() can size */
+#define UNFLATTEN_MAX_DEPTH	32
+
+unsigned long unflatten_device_tree_size(const void *blob)
+{
+	const unsigned long align = max(__alignof__(struct device_node),
+					__alignof__(struct property));
+	unsigned long fpsize[UNFLATTEN_MAX_DEPTH];
+	unsigned long size = 0, allocl;
+	int offset = 0, next;
+	int depth = -1;
+	const char *name;
+	uint32_t tag;
+	int len;
+
+	do {
+		tag = fdt_next_tag(blob, offset, &next);
+		switch (tag) {
+		case FDT_BEGIN_NODE:
+			if (++depth >= UNFLATTEN_MAX_DEPTH)
+				return 0;
+			name = fdt_get_name(blob, offset, &len);
+			if (!name)
+				return 0;
+			/* Full path as built by unflatten_dt_node() */
+			if (*name == '/')
+				allocl = len + 1;
+			else if (!depth)
+				allocl = 2;
+			else
+				allocl = fpsize[depth - 1] + len + 1;
+			fpsize[depth] = depth ? allocl : 1;
+			size += ALIGN(sizeof(struct device_node) + allocl,
+				      align);
+			/* Allow for a "name" property made from the unit name */
+			size += ALIGN(sizeof(struct property) + len + 1, align);
+			break;
+		case FDT_PROP:
+			size += ALIGN(sizeof(struct property), align);
+			break;
+		case FDT_END_NODE:
+			depth--;
+			break;
+		}
+		offset = next;
+	} while (tag != FDT_END && offset >= 0);
+
+	return offset < 0 ? 0 : size;
+}
+
+int unflatten_device_tree(const void *blob, struct device_node **mynodes)
 {
 	unsigned long size;
 	int start;
@@ -283,30 +337,56 @@ static int unflatten_device_tree(const void *blob,
 		return -EINVAL;
 	}
 
-	/* First pass, scan for size */
-	start = 0;
-	size = (unsigned long)unflatten_dt_node(blob, NULL, &start, NULL, NULL,
-						0, true);
-	if (!size)
-		return -EFAULT;
-	size = ALIGN(size, 4);
-
-	debug("  size is %lx, allocating...\n", size);
-
-	/* Allocate memory for the expanded device tree */
-	mem = malloc(size + 4);
-	memset(mem, '\0', size);
+	/*
+	 * Size the tree from its tags first, which is much quicker than
+	 * walking it twice with unflatten_dt_node()
+	 */
+	size = unflatten_device_tree_size(blob);
+	mem = NULL;
+	if (size) {
+		debug("  size is at most %lx, allocating...\n", size);
+		mem = calloc(1, size + 4);
+		if (!mem)
+			return -ENOMEM;
+		*(__be32 *)(mem + size) = cpu_to_be32(0xdeadbeef);
+	}
 
-	*(__be32 *)(mem + size) = cpu_to_be32(0xdeadbeef);
+	start = 0;
+	if (!mem || !unflatten_dt_node(blob, mem, mem + size, &start, NULL,
+				       mynodes, 0, false)) {
+		free(mem);
+
+		/* First pass, scan for size */
+		start = 0;
+		size = (unsigned long)unflatten_dt_node(blob, NULL, NULL,
+							&start, NULL, NULL,
+							0, true);
+		if (!size)
+			return -EFAULT;
+		size = ALIGN(size, 4);
+
+		debug("  size is %lx, allocating...\n", size);
+
+		/* Allocate memory for the expanded device tree */
+		mem = calloc(1, size + 4);
+		if (!mem)
+			return -ENOMEM;
+		*(__be32 *)(mem + size) = cpu_to_be32(0xdeadbeef);
 
-	debug("  unflattening %p...\n", mem);
+		debug("  unflattening %p...\n", mem);
 
-	/* Second pass, do actual unflattening */
-	start = 0;
-	unflatten_dt_node(blob, mem, &start, NULL, mynodes, 0, false);
+		/* Second pass, do actual unflattening */
+		start = 0;
+		if (!unflatten_dt_node(blob, mem, mem + size, &start, NULL,
+				       mynodes, 0, false)) {
+			free(mem);
+			return -EFAULT;
+		}
+	}
 	if (be32_to_cpup(mem + size) != 0xdeadbeef) {
 		debug("End of tree marker overwritten: %08x\n",
 		      be32_to_cpup(mem + size));
+		free(mem);
 		return -ENOSPC;
 	}
 
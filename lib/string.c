@@ -565,6 +565,7 @@ void * memcpy(void *dest, const void *src, size_t count)
  */
 void * memmove(void * dest,const void *src,size_t count)
 {
+	unsigned long *dl, *sl;
 	char *tmp, *s;
 
 	if (dest <= src) {
@@ -572,6 +573,18 @@ void * memmove(void * dest,const void *src,size_t count)
 	} else {
 		tmp = (char *) dest + count;
 		s = (char *) src + count;
+
+		/* as with memcpy(), copy a word at a time when aligned */
+		if ((((ulong)tmp | (ulong)s) & (sizeof(*dl) - 1)) == 0) {
+			dl = (unsigned long *)tmp;
+			sl = (unsigned long *)s;
+			while (count >= sizeof(*dl)) {
+				*--dl = *--sl;
+				count -= sizeof(*dl);
+			}
+			tmp = (char *)dl;
+			s = (char *)sl;
+		}
 		while (count--)
 			*--tmp = *--s;
 		}
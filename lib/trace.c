@@ -9,12 +9,22 @@
 #include <trace.h>
 #include <asm/io.h>
 #include <asm/sections.h>
+#include <linux/bitops.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
 static char trace_enabled __attribute__((section(".data")));
 static char trace_inited __attribute__((section(".data")));
 
+enum {
+	/*
+	 * Number of call depths for which we remember whether the entry was
+	 * recorded. Depths are taken modulo this, so it must be larger than
+	 * the number of frames open at once since tracing started.
+	 */
+	TRACE_DEPTHS = 1024,
+};
+
 /* The header block at the start of the trace memory area */
 struct trace_hdr {
 	int func_count;		/* Total number of function call sites */
@@ -28,15 +38,37 @@ struct trace_hdr {
 	 */
 	uintptr_t *call_accum;
 
-	/* Function trace list */
-	struct trace_call *ftrace;	/* The function call records */
-	ulong ftrace_size;	/* Num. of ftrace records we have space for */
+	/* Bitmap of function sites which are not added to the call trace */
+	ulong *filter;
+
+	/*
+	 * Function call trace, a ring buffer of variable-length records as
+	 * described for struct trace_ring_hdr. When it is full the oldest
+	 * records are overwritten.
+	 */
+	u8 *ring;		/* The function call records */
+	ulong ring_size;	/* Size of the ring buffer in bytes */
+	ulong ring_head;	/* Offset at which to write the next record */
+	ulong ring_tail;	/* Offset of the oldest record */
+	ulong ring_used;	/* Number of bytes of records in the ring */
+	ulong last_us;		/* Timer value when the last record was added */
+	u64 tail_time;		/* Time before the oldest record, in us */
 	ulong ftrace_count;	/* Num. of ftrace records written */
+	ulong ftrace_dropped;	/* Num. of ftrace records overwritten */
 	ulong ftrace_too_deep_count;	/* Functions that were too deep */
+	ulong ftrace_filtered_count;	/* Functions that were filtered out */
 
 	int depth;
 	int depth_limit;
 	int max_depth;
+
+	/*
+	 * Bitmap of call depths (modulo TRACE_DEPTHS) whose entry was added
+	 * to the call trace, so that the exit is added too. This keeps the
+	 * trace balanced when the depth limit or filter changes while
+	 * functions are running.
+	 */
+	ulong traced[BITS_TO_LONGS(TRACE_DEPTHS)];
 };
 
 static struct trace_hdr *hdr;	/* Pointer to start of trace buffer */
@@ -100,32 +132,108 @@ static void __attribute__((no_instrument_function)) trace_swap_gd(void)
 
 #endif
 
-static void __attribute__((no_instrument_function)) add_ftrace(void *func_ptr,
-				void *caller, ulong flags)
+static bool __attribute__((no_instrument_function)) is_filtered(ulong func)
 {
-	if (hdr->depth > hdr->depth_limit) {
-		hdr->ftrace_too_deep_count++;
-		return;
-	}
-	if (hdr->ftrace_count < hdr->ftrace_size) {
-		struct trace_call *rec = &hdr->ftrace[hdr->ftrace_count];
+	if (func >= hdr->func_count)
+		return false;
 
-		rec->func = func_ptr_to_num(func_ptr);
-		rec->caller = func_ptr_to_num(caller);
-		rec->flags = flags | (timer_get_us() & FUNCF_TIMESTAMP_MASK);
-	}
-	hdr->ftrace_count++;
+	return hdr->filter[func / BITS_PER_LONG] & (1UL << (func % BITS_PER_LONG));
+}
+
+/* Record whether the function entered at the current depth was traced */
+static void __attribute__((no_instrument_function)) set_traced(bool traced)
+{
+	uint bit = (uint)hdr->depth % TRACE_DEPTHS;
+	ulong mask = 1UL << (bit % BITS_PER_LONG);
+
+	if (traced)
+		hdr->traced[bit / BITS_PER_LONG] |= mask;
+	else
+		hdr->traced[bit / BITS_PER_LONG] &= ~mask;
+}
+
+/* Check whether the function entered at the current depth was traced */
+static bool __attribute__((no_instrument_function)) get_traced(void)
+{
+	uint bit = (uint)hdr->depth % TRACE_DEPTHS;
+
+	return hdr->traced[bit / BITS_PER_LONG] & (1UL << (bit % BITS_PER_LONG));
+}
+
+static int __attribute__((no_instrument_function)) put_uleb128(u8 *buf,
+							      u64 val)
+{
+	int len = 0;
+
+	do {
+		buf[len] = val & 0x7f;
+		val >>= 7;
+		if (val)
+			buf[len] |= 0x80;
+		len++;
+	} while (val);
+
+	return len;
+}
+
+static u64 __attribute__((no_instrument_function)) get_uleb128(ulong *posp)
+{
+	ulong pos = *posp;
+	u64 val = 0;
+	int shift = 0;
+	u8 byte;
+
+	do {
+		byte = hdr->ring[pos];
+		if (++pos == hdr->ring_size)
+			pos = 0;
+		val |= (u64)(byte & 0x7f) << shift;
+		shift += 7;
+	} while (byte & 0x80);
+	*posp = pos;
+
+	return val;
+}
+
+/* Drop the oldest record from the ring to make space for a new one */
+static void __attribute__((no_instrument_function)) drop_ftrace(void)
+{
+	ulong pos = hdr->ring_tail;
+	u64 val;
+
+	val = get_uleb128(&pos);
+	if (!(val & 1))
+		get_uleb128(&pos);
+	hdr->tail_time += val >> 1;
+	if (pos < hdr->ring_tail)
+		pos += hdr->ring_size;
+	hdr->ring_used -= pos - hdr->ring_tail;
+	hdr->ring_tail = pos % hdr->ring_size;
+	hdr->ftrace_dropped++;
 }
 
-static void __attribute__((no_instrument_function)) add_textbase(void)
+static void __attribute__((no_instrument_function)) add_ftrace(void *func_ptr,
+							      bool exit)
 {
-	if (hdr->ftrace_count < hdr->ftrace_size) {
-		struct trace_call *rec = &hdr->ftrace[hdr->ftrace_count];
+	u8 rec[TRACE_RING_REC_MAX];
+	ulong now = timer_get_us();
+	int len, i;
+
+	len = put_uleb128(rec, (u64)(now - hdr->last_us) << 1 | exit);
+	if (!exit)
+		len += put_uleb128(rec + len, func_ptr_to_num(func_ptr));
+	if (len > hdr->ring_size)
+		return;
 
-		rec->func = CONFIG_SYS_TEXT_BASE;
-		rec->caller = 0;
-		rec->flags = FUNCF_TEXTBASE;
+	while (hdr->ring_size - hdr->ring_used < len)
+		drop_ftrace();
+	for (i = 0; i < len; i++) {
+		hdr->ring[hdr->ring_head] = rec[i];
+		if (++hdr->ring_head == hdr->ring_size)
+			hdr->ring_head = 0;
 	}
+	hdr->ring_used += len;
+	hdr->last_us = now;
 	hdr->ftrace_count++;
 }
 
@@ -142,10 +250,9 @@ void __attribute__((no_instrument_function)) __cyg_profile_func_enter(
 		void *func_ptr, void *caller)
 {
 	if (trace_enabled) {
-		int func;
+		ulong func;
 
 		trace_swap_gd();
-		add_ftrace(func_ptr, caller, FUNCF_ENTRY);
 		func = func_ptr_to_num(func_ptr);
 		if (func < hdr->func_count) {
 			hdr->call_accum[func]++;
@@ -153,8 +260,18 @@ void __attribute__((no_instrument_function)) __cyg_profile_func_enter(
 		} else {
 			hdr->untracked_count++;
 		}
+		if (hdr->depth > hdr->depth_limit) {
+			hdr->ftrace_too_deep_count++;
+			set_traced(false);
+		} else if (is_filtered(func)) {
+			hdr->ftrace_filtered_count++;
+			set_traced(false);
+		} else {
+			add_ftrace(func_ptr, false);
+			set_traced(true);
+		}
 		hdr->depth++;
-		if (hdr->depth > hdr->depth_limit)
+		if (hdr->depth > hdr->max_depth)
 			hdr->max_depth = hdr->depth;
 		trace_swap_gd();
 	}
@@ -163,6 +280,10 @@ void __attribute__((no_instrument_function)) __cyg_profile_func_enter(
 /**
  * __cyg_profile_func_exit() - record function exit
  *
+ * The exit is recorded only if the entry was, so that each recorded entry
+ * has a recorded exit even if the depth limit or filter has changed since.
+ * Functions entered before tracing started are not recorded.
+ *
  * @func_ptr:	pointer to function being entered
  * @caller:	pointer to function which called this function
  */
@@ -171,8 +292,11 @@ void __attribute__((no_instrument_function)) __cyg_profile_func_exit(
 {
 	if (trace_enabled) {
 		trace_swap_gd();
-		add_ftrace(func_ptr, caller, FUNCF_EXIT);
 		hdr->depth--;
+		if (get_traced()) {
+			add_ftrace(func_ptr, true);
+			set_traced(false);
+		}
 		trace_swap_gd();
 	}
 }
@@ -234,11 +358,22 @@ int trace_list_functions(void *buff, size_t buff_size, size_t *needed)
 	return 0;
 }
 
+/* Copy the records in a ring buffer to @dest, oldest first */
+static void __attribute__((no_instrument_function)) unwrap_ring(
+		struct trace_hdr *src, u8 *dest)
+{
+	ulong first;
+
+	first = min(src->ring_used, src->ring_size - src->ring_tail);
+	memcpy(dest, src->ring + src->ring_tail, first);
+	memcpy(dest + first, src->ring, src->ring_used - first);
+}
+
 /**
- * trace_list_functions() - produce a list of function calls
+ * trace_list_calls() - produce a list of function calls
  *
  * The information is written into the supplied buffer - a header followed
- * by a list of function records.
+ * by the call records, oldest first.
  *
  * @buff:	buffer to place list into
  * @buff_size:	size of buffer
@@ -248,45 +383,73 @@ int trace_list_functions(void *buff, size_t buff_size, size_t *needed)
  */
 int trace_list_calls(void *buff, size_t buff_size, size_t *needed)
 {
-	struct trace_output_hdr *output_hdr = NULL;
-	void *end, *ptr = buff;
-	size_t rec, upto;
-	size_t count;
+	struct trace_output_hdr *output_hdr;
+	struct trace_ring_hdr *ring_hdr;
+	char enabled;
 
-	end = buff ? buff + buff_size : NULL;
+	*needed = sizeof(*output_hdr) + sizeof(*ring_hdr) + hdr->ring_used;
+	if (!buff || *needed > buff_size)
+		return -ENOSPC;
 
-	/* Place some header information */
-	if (ptr + sizeof(struct trace_output_hdr) < end)
-		output_hdr = ptr;
-	ptr += sizeof(struct trace_output_hdr);
+	output_hdr = buff;
+	output_hdr->type = TRACE_CHUNK_RING;
+	output_hdr->rec_count = hdr->ring_used;
 
-	/* Add information about each call */
-	count = hdr->ftrace_count;
-	if (count > hdr->ftrace_size)
-		count = hdr->ftrace_size;
-	for (rec = upto = 0; rec < count; rec++) {
-		if (ptr + sizeof(struct trace_call) < end) {
-			struct trace_call *call = &hdr->ftrace[rec];
-			struct trace_call *out = ptr;
-
-			out->func = call->func * FUNC_SITE_SIZE;
-			out->caller = call->caller * FUNC_SITE_SIZE;
-			out->flags = call->flags;
-			upto++;
-		}
-		ptr += sizeof(struct trace_call);
-	}
+	ring_hdr = (struct trace_ring_hdr *)(output_hdr + 1);
+	ring_hdr->base_time = hdr->tail_time;
+	ring_hdr->dropped = hdr->ftrace_dropped;
+	ring_hdr->text_base = CONFIG_SYS_TEXT_BASE;
+	ring_hdr->reserved = 0;
 
-	/* Update the header */
-	if (output_hdr) {
-		output_hdr->rec_count = upto;
-		output_hdr->type = TRACE_CHUNK_CALLS;
-	}
+	/* Avoid adding records while we copy them */
+	enabled = trace_enabled;
+	trace_enabled = 0;
+	unwrap_ring(hdr, (u8 *)(ring_hdr + 1));
+	trace_enabled = enabled;
 
-	/* Work out how must of the buffer we used */
-	*needed = ptr - buff;
-	if (ptr > end)
-		return -ENOSPC;
+	return 0;
+}
+
+/**
+ * trace_set_depth_limit() - set the maximum call depth to record
+ *
+ * @limit:	maximum depth to record
+ */
+void trace_set_depth_limit(int limit)
+{
+	if (trace_inited)
+		hdr->depth_limit = limit;
+}
+
+/**
+ * trace_set_filter() - include or exclude functions from the call trace
+ *
+ * @start:	offset of the first function to change
+ * @size:	number of bytes of code to change
+ * @include:	true to record calls to these functions, false to drop them
+ * Return:	0 if ok, -EINVAL if the range is outside U-Boot, -ENOENT if
+ *		trace is not set up
+ */
+int trace_set_filter(ulong start, ulong size, bool include)
+{
+	ulong func, end;
+
+	if (!trace_inited)
+		return -ENOENT;
+	func = start / FUNC_SITE_SIZE;
+	end = DIV_ROUND_UP(start + size, FUNC_SITE_SIZE);
+	if (func >= hdr->func_count || end < func)
+		return -EINVAL;
+	end = min(end, (ulong)hdr->func_count);
+
+	for (; func < end; func++) {
+		ulong mask = 1UL << (func % BITS_PER_LONG);
+
+		if (include)
+			hdr->filter[func / BITS_PER_LONG] &= ~mask;
+		else
+			hdr->filter[func / BITS_PER_LONG] |= mask;
+	}
 
 	return 0;
 }
@@ -296,8 +459,6 @@ int trace_list_calls(void *buff, size_t buff_size, size_t *needed)
  */
 void trace_print_stats(void)
 {
-	ulong count;
-
 #ifndef FTRACE
 	puts("Warning: make U-Boot with FTRACE to enable function instrumenting.\n");
 	puts("You will likely get zeroed data here\n");
@@ -312,18 +473,20 @@ void trace_print_stats(void)
 	puts(" function calls\n");
 	print_grouped_ull(hdr->untracked_count, 10);
 	puts(" untracked function calls\n");
-	count = min(hdr->ftrace_count, hdr->ftrace_size);
-	print_grouped_ull(count, 10);
+	print_grouped_ull(hdr->ftrace_count, 10);
 	puts(" traced function calls");
-	if (hdr->ftrace_count > hdr->ftrace_size) {
-		printf(" (%lu dropped due to overflow)",
-		       hdr->ftrace_count - hdr->ftrace_size);
-	}
+	if (hdr->ftrace_dropped)
+		printf(" (%lu oldest dropped due to overflow)",
+		       hdr->ftrace_dropped);
 	puts("\n");
+	print_grouped_ull(hdr->ring_used, 10);
+	printf(" of %lu bytes of call trace used\n", hdr->ring_size);
 	printf("%15d maximum observed call depth\n", hdr->max_depth);
 	printf("%15d call depth limit\n", hdr->depth_limit);
 	print_grouped_ull(hdr->ftrace_too_deep_count, 10);
 	puts(" calls not traced due to depth\n");
+	print_grouped_ull(hdr->ftrace_filtered_count, 10);
+	puts(" calls not traced due to filter\n");
 }
 
 void __attribute__((no_instrument_function)) trace_set_enabled(int enabled)
@@ -331,6 +494,85 @@ void __attribute__((no_instrument_function)) trace_set_enabled(int enabled)
 	trace_enabled = enabled != 0;
 }
 
+/**
+ * trace_setup_buff() - set up the trace header at the start of a buffer
+ *
+ * The header is followed by the function call counts and the filter bitmap.
+ * The rest of the buffer holds the function call trace.
+ *
+ * @buff:	Pointer to trace buffer
+ * @buff_size:	Size of trace buffer
+ * Return:	0 if ok, -ENOSPC if the buffer is too small
+ */
+static int __attribute__((no_instrument_function)) trace_setup_buff(
+		void *buff, size_t buff_size)
+{
+	ulong func_count = gd->mon_len / FUNC_SITE_SIZE;
+	size_t filter_size = BITS_TO_LONGS(func_count) * sizeof(ulong);
+	size_t needed;
+
+	needed = sizeof(*hdr) + func_count * sizeof(uintptr_t) + filter_size;
+	if (needed + TRACE_RING_REC_MAX > buff_size) {
+		printf("trace: buffer size %zd bytes: at least %zd needed\n",
+		       buff_size, needed + TRACE_RING_REC_MAX);
+		return -ENOSPC;
+	}
+
+	hdr = buff;
+	memset(hdr, '\0', needed);
+	hdr->func_count = func_count;
+	hdr->call_accum = (uintptr_t *)(hdr + 1);
+	hdr->filter = (ulong *)(hdr->call_accum + func_count);
+
+	/* Use any remaining space for the timed function trace */
+	hdr->ring = (u8 *)buff + needed;
+	hdr->ring_size = buff_size - needed;
+	hdr->last_us = timer_get_us();
+	hdr->tail_time = hdr->last_us;
+
+	return 0;
+}
+
+#ifdef CONFIG_TRACE_EARLY
+/**
+ * trace_copy_early() - copy the early trace data into the new buffer
+ *
+ * If the early call trace does not fit, the oldest records are dropped.
+ *
+ * @early:	Header of the early trace buffer
+ */
+static void __attribute__((no_instrument_function)) trace_copy_early(
+		struct trace_hdr *early)
+{
+	struct trace_hdr *new_hdr = hdr;
+
+	hdr = early;
+	while (early->ring_used > new_hdr->ring_size)
+		drop_ftrace();
+	hdr = new_hdr;
+
+	memcpy(hdr->call_accum, early->call_accum,
+	       hdr->func_count * sizeof(uintptr_t));
+	memcpy(hdr->filter, early->filter,
+	       BITS_TO_LONGS(hdr->func_count) * sizeof(ulong));
+	hdr->call_count = early->call_count;
+	hdr->untracked_count = early->untracked_count;
+	hdr->ftrace_count = early->ftrace_count;
+	hdr->ftrace_dropped = early->ftrace_dropped;
+	hdr->ftrace_too_deep_count = early->ftrace_too_deep_count;
+	hdr->ftrace_filtered_count = early->ftrace_filtered_count;
+	hdr->depth = early->depth;
+	hdr->max_depth = early->max_depth;
+	memcpy(hdr->traced, early->traced, sizeof(hdr->traced));
+
+	unwrap_ring(early, hdr->ring);
+	hdr->ring_used = early->ring_used;
+	hdr->ring_head = hdr->ring_used % hdr->ring_size;
+	hdr->last_us = early->last_us;
+	hdr->tail_time = early->tail_time;
+}
+#endif
+
 /**
  * trace_init() - initialize the tracing system and enable it
  *
@@ -341,53 +583,35 @@ void __attribute__((no_instrument_function)) trace_set_enabled(int enabled)
 int __attribute__((no_instrument_function)) trace_init(void *buff,
 		size_t buff_size)
 {
-	ulong func_count = gd->mon_len / FUNC_SITE_SIZE;
-	size_t needed;
+	struct trace_hdr *early = NULL;
 	int was_disabled = !trace_enabled;
+	int ret;
 
 	trace_save_gd();
 
 	if (!was_disabled) {
 #ifdef CONFIG_TRACE_EARLY
-		char *end;
-		ulong used;
-
 		/*
 		 * Copy over the early trace data if we have it. Disable
 		 * tracing while we are doing this.
 		 */
 		trace_enabled = 0;
-		hdr = map_sysmem(CONFIG_TRACE_EARLY_ADDR,
-				 CONFIG_TRACE_EARLY_SIZE);
-		end = (char *)&hdr->ftrace[min(hdr->ftrace_count,
-					       hdr->ftrace_size)];
-		used = end - (char *)hdr;
+		early = hdr;
 		printf("trace: copying %08lx bytes of early data from %x to %08lx\n",
-		       used, CONFIG_TRACE_EARLY_ADDR,
+		       early->ring_used, CONFIG_TRACE_EARLY_ADDR,
 		       (ulong)map_to_sysmem(buff));
-		memcpy(buff, hdr, used);
 #else
 		puts("trace: already enabled\n");
 		return -EALREADY;
 #endif
 	}
-	hdr = (struct trace_hdr *)buff;
-	needed = sizeof(*hdr) + func_count * sizeof(uintptr_t);
-	if (needed > buff_size) {
-		printf("trace: buffer size %zd bytes: at least %zd needed\n",
-		       buff_size, needed);
-		return -ENOSPC;
-	}
-
-	if (was_disabled)
-		memset(hdr, '\0', needed);
-	hdr->func_count = func_count;
-	hdr->call_accum = (uintptr_t *)(hdr + 1);
-
-	/* Use any remaining space for the timed function trace */
-	hdr->ftrace = (struct trace_call *)(buff + needed);
-	hdr->ftrace_size = (buff_size - needed) / sizeof(*hdr->ftrace);
-	add_textbase();
+	ret = trace_setup_buff(buff, buff_size);
+	if (ret)
+		return ret;
+#ifdef CONFIG_TRACE_EARLY
+	if (early)
+		trace_copy_early(early);
+#endif
 
 	puts("trace: enabled\n");
 	hdr->depth_limit = CONFIG_TRACE_CALL_DEPTH_LIMIT;
@@ -405,30 +629,17 @@ int __attribute__((no_instrument_function)) trace_init(void *buff,
  */
 int __attribute__((no_instrument_function)) trace_early_init(void)
 {
-	ulong func_count = gd->mon_len / FUNC_SITE_SIZE;
-	size_t buff_size = CONFIG_TRACE_EARLY_SIZE;
-	size_t needed;
+	int ret;
 
 	/* We can ignore additional calls to this function */
 	if (trace_enabled)
 		return 0;
 
-	hdr = map_sysmem(CONFIG_TRACE_EARLY_ADDR, CONFIG_TRACE_EARLY_SIZE);
-	needed = sizeof(*hdr) + func_count * sizeof(uintptr_t);
-	if (needed > buff_size) {
-		printf("trace: buffer size is %zd bytes, at least %zd needed\n",
-		       buff_size, needed);
-		return -ENOSPC;
-	}
-
-	memset(hdr, '\0', needed);
-	hdr->call_accum = (uintptr_t *)(hdr + 1);
-	hdr->func_count = func_count;
-
-	/* Use any remaining space for the timed function trace */
-	hdr->ftrace = (struct trace_call *)((char *)hdr + needed);
-	hdr->ftrace_size = (buff_size - needed) / sizeof(*hdr->ftrace);
-	add_textbase();
+	ret = trace_setup_buff(map_sysmem(CONFIG_TRACE_EARLY_ADDR,
+					  CONFIG_TRACE_EARLY_SIZE),
+			       CONFIG_TRACE_EARLY_SIZE);
+	if (ret)
+		return ret;
 	hdr->depth_limit = CONFIG_TRACE_EARLY_CALL_DEPTH_LIMIT;
 	printf("trace: early enable at %08x\n", CONFIG_TRACE_EARLY_ADDR);
 
@@ -31,6 +31,36 @@
 #  define PUP(a) *++(a)
 #endif
 
+/*
+   With a 64-bit bit buffer, refill hold with a single unaligned eight-byte
+   load and advance in by the whole bytes that fit.  This leaves at least 56
+   bits in hold, which covers a complete length/distance pair, so the refills
+   further down the loop are never taken.  The unconsumed bits of the last
+   byte loaded sit above bits in hold; they are exactly what the next refill
+   loads again, so OR-ing the new data in is harmless.  This needs eight
+   readable input bytes, see INFLATE_FAST_MIN_IN.
+ */
+#if BITS_PER_LONG == 64
+#  define REFILL() \
+    do { \
+        if (bits < 48) { \
+            hold |= (unsigned long)get_unaligned_le64(in + OFF) << bits; \
+            in += (63 - bits) >> 3; \
+            bits |= 56; \
+        } \
+    } while (0)
+#else
+#  define REFILL() \
+    do { \
+        if (bits < 15) { \
+            hold += (unsigned long)(PUP(in)) << bits; \
+            bits += 8; \
+            hold += (unsigned long)(PUP(in)) << bits; \
+            bits += 8; \
+        } \
+    } while (0)
+#endif
+
 /*
    Decode literal, length, and distance codes and write out the resulting
    literal and match bytes until either not enough input or output is
@@ -47,6 +77,8 @@
         start >= strm->avail_out
         state->bits < 8
 
+   (strm->avail_in >= 8 rather than 6 with a 64-bit bit buffer.)
+
    On return, state->mode is one of:
 
         LEN -- ran out of enough output space or enough available input
@@ -98,14 +130,14 @@ void inflate_fast(z_streamp strm, unsigned start)
     /* copy state to local variables */
     state = (struct inflate_state FAR *)strm->state;
     in = strm->next_in - OFF;
-    last = in + (strm->avail_in - 5);
-    if (in > last && strm->avail_in > 5) {
+    last = in + (strm->avail_in - (INFLATE_FAST_MIN_IN - 1));
+    if (in > last && strm->avail_in > INFLATE_FAST_MIN_IN - 1) {
         /*
          * overflow detected, limit strm->avail_in to the
          * max. possible size and recalculate last
          */
 	strm->avail_in = 0xffffffff - (uintptr_t)in;
-        last = in + (strm->avail_in - 5);
+        last = in + (strm->avail_in - (INFLATE_FAST_MIN_IN - 1));
     }
     out = strm->next_out - OFF;
     beg = out - (start - strm->avail_out);
@@ -127,12 +159,7 @@ void inflate_fast(z_streamp strm, unsigned start)
     /* decode literals and length/distances until end-of-block or not enough
        input data or output space */
     do {
-        if (bits < 15) {
-            hold += (unsigned long)(PUP(in)) << bits;
-            bits += 8;
-            hold += (unsigned long)(PUP(in)) << bits;
-            bits += 8;
-        }
+        REFILL();
         this = lcode[hold & lmask];
       dolen:
         op = (unsigned)(this.bits);
@@ -252,6 +279,21 @@ void inflate_fast(z_streamp strm, unsigned start)
                             PUP(out) = PUP(from);
                     }
                 }
+                else if (dist >= sizeof(unsigned long)) {
+                    /* copy direct from output a word at a time; the
+                       source of each word is already written */
+                    from = out - dist;
+                    while (len >= sizeof(unsigned long)) {
+                        put_unaligned(get_unaligned(
+                                (unsigned long *)(from + OFF)),
+                                (unsigned long *)(out + OFF));
+                        from += sizeof(unsigned long);
+                        out += sizeof(unsigned long);
+                        len -= sizeof(unsigned long);
+                    }
+                    while (len--)
+                        PUP(out) = PUP(from);
+                }
                 else {
 		    unsigned short *sout;
 		    unsigned long loops;
@@ -331,7 +373,9 @@ void inflate_fast(z_streamp strm, unsigned start)
     /* update state and return */
     strm->next_in = in + OFF;
     strm->next_out = out + OFF;
-    strm->avail_in = (unsigned)(in < last ? 5 + (last - in) : 5 - (in - last));
+    strm->avail_in = (unsigned)(in < last ?
+                                (INFLATE_FAST_MIN_IN - 1) + (last - in) :
+                                (INFLATE_FAST_MIN_IN - 1) - (in - last));
     strm->avail_out = (unsigned)(out < end ?
                                  257 + (end - out) : 257 - (out - end));
     state->hold = hold;
@@ -8,4 +8,15 @@
    subject to change. Applications should only use zlib.h.
  */
 
+/*
+ * Input bytes inflate_fast() needs on entry.  With a 64-bit bit buffer it
+ * refills with a single unaligned eight-byte load, so it must be able to
+ * read that far ahead.
+ */
+#if BITS_PER_LONG == 64
+#  define INFLATE_FAST_MIN_IN 8
+#else
+#  define INFLATE_FAST_MIN_IN 6
+#endif
+
 void inflate_fast OF((z_streamp strm, unsigned start));
@@ -11,6 +11,7 @@
 #include <env.h>
 #include <log.h>
 #include <net.h>
+#include <perf_counter.h>
 #include <dm/device-internal.h>
 #include <dm/uclass-internal.h>
 #include <net/pcap.h>
@@ -342,6 +343,7 @@ int eth_is_active(struct udevice *dev)
 int eth_send(void *packet, int length)
 {
 	struct udevice *current;
+	ulong perf_start;
 	int ret;
 
 	current = eth_get_dev();
@@ -351,10 +353,16 @@ int eth_send(void *packet, int length)
 	if (!eth_is_active(current))
 		return -EINVAL;
 
+	perf_start = perf_time_start();
 	ret = eth_get_ops(current)->send(current, packet, length);
+	perf_time_end(PERF_ETH, perf_start);
 	if (ret < 0) {
+		perf_add(PERF_ETH, PERF_CNT_ERRORS, 1);
 		/* We cannot completely return the error at present */
 		debug("%s: send() returned error %d\n", __func__, ret);
+	} else {
+		perf_add(PERF_ETH, PERF_CNT_WRITES, 1);
+		perf_add(PERF_ETH, PERF_CNT_WRITE_BYTES, length);
 	}
 #if defined(CONFIG_CMD_PCAP)
 	if (ret >= 0)
@@ -366,6 +374,7 @@ int eth_send(void *packet, int length)
 int eth_rx(void)
 {
 	struct udevice *current;
+	ulong perf_start;
 	uchar *packet;
 	int flags;
 	int ret;
@@ -381,10 +390,16 @@ int eth_rx(void)
 	/* Process up to 32 packets at one time */
 	flags = ETH_RECV_CHECK_DEVICE;
 	for (i = 0; i < 32; i++) {
+		perf_start = perf_time_start();
 		ret = eth_get_ops(current)->recv(current, flags, &packet);
 		flags = 0;
-		if (ret > 0)
+		if (ret > 0) {
+			/* Don't count the time spent polling an idle device */
+			perf_time_end(PERF_ETH, perf_start);
+			perf_add(PERF_ETH, PERF_CNT_READS, 1);
+			perf_add(PERF_ETH, PERF_CNT_READ_BYTES, ret);
 			net_process_received_packet(packet, ret);
+		}
 		if (ret >= 0 && eth_get_ops(current)->free_pkt)
 			eth_get_ops(current)->free_pkt(current, packet, ret);
 		if (ret <= 0)
@@ -393,6 +408,7 @@ int eth_rx(void)
 	if (ret == -EAGAIN)
 		ret = 0;
 	if (ret < 0) {
+		perf_add(PERF_ETH, PERF_CNT_ERRORS, 1);
 		/* We cannot completely return the error at present */
 		debug("%s: recv() returned error %d\n", __func__, ret);
 	}
@@ -14,10 +14,28 @@ static const char test_cmd[] = "setenv list 1\n setenv list ${list}2; "
 		"setenv list ${list}3\0"
 		"setenv list ${list}4";
 
+static void check_cmd_lookup(void)
+{
+	struct cmd_tbl *start = ll_entry_start(struct cmd_tbl, cmd);
+	const int count = ll_entry_count(struct cmd_tbl, cmd);
+	struct cmd_tbl *cmdtp;
+
+	/* find_cmd() relies on the linker sorting the list by command name */
+	for (cmdtp = start + 1; cmdtp < start + count; cmdtp++)
+		assert(strcmp(cmdtp[-1].name, cmdtp->name) < 0);
+
+	for (cmdtp = start; cmdtp < start + count; cmdtp++)
+		assert(find_cmd(cmdtp->name) == cmdtp);
+	assert(find_cmd("ut_cm") == find_cmd("ut_cmd"));
+	assert(find_cmd("echo.b") == find_cmd("echo"));
+	assert(!find_cmd("no_such_command"));
+}
+
 static int do_ut_cmd(struct cmd_tbl *cmdtp, int flag, int argc,
 		     char *const argv[])
 {
 	printf("%s: Testing commands\n", __func__);
+	check_cmd_lookup();
 	run_command("env default -f -a", 0);
 
 	/* commands separated by \n */
@@ -12,6 +12,7 @@
 #include <lz4.h>
 #include <malloc.h>
 #include <mapmem.h>
+#include <time.h>
 #include <asm/io.h>
 
 #include <u-boot/zlib.h>
@@ -121,6 +122,35 @@ static const char lz4_compressed[] =
 	"\x9d\x12\x8c\x9d";
 static const unsigned long lz4_compressed_size = 276;
 
+/*
+ * zstd frame holding plain in a single raw block, with a content checksum.
+ * There is no zstd compressor to hand, so this was assembled by hand.
+ */
+static const char zstd_compressed[] =
+	"\x28\xb5\x2f\xfd\x64\x5e\x00\xf1\x0a\x00\x49\x20\x61\x6d\x20\x61"
+	"\x20\x68\x69\x67\x68\x6c\x79\x20\x63\x6f\x6d\x70\x72\x65\x73\x73"
+	"\x61\x62\x6c\x65\x20\x62\x69\x74\x20\x6f\x66\x20\x74\x65\x78\x74"
+	"\x2e\x0a\x49\x20\x61\x6d\x20\x61\x20\x68\x69\x67\x68\x6c\x79\x20"
+	"\x63\x6f\x6d\x70\x72\x65\x73\x73\x61\x62\x6c\x65\x20\x62\x69\x74"
+	"\x20\x6f\x66\x20\x74\x65\x78\x74\x2e\x0a\x49\x20\x61\x6d\x20\x61"
+	"\x20\x68\x69\x67\x68\x6c\x79\x20\x63\x6f\x6d\x70\x72\x65\x73\x73"
+	"\x61\x62\x6c\x65\x20\x62\x69\x74\x20\x6f\x66\x20\x74\x65\x78\x74"
+	"\x2e\x0a\x54\x68\x65\x72\x65\x20\x61\x72\x65\x20\x6d\x61\x6e\x79"
+	"\x20\x6c\x69\x6b\x65\x20\x6d\x65\x2c\x20\x62\x75\x74\x20\x74\x68"
+	"\x69\x73\x20\x6f\x6e\x65\x20\x69\x73\x20\x6d\x69\x6e\x65\x2e\x0a"
+	"\x49\x66\x20\x49\x20\x77\x65\x72\x65\x20\x61\x6e\x79\x20\x73\x68"
+	"\x6f\x72\x74\x65\x72\x2c\x20\x74\x68\x65\x72\x65\x20\x77\x6f\x75"
+	"\x6c\x64\x6e\x27\x74\x20\x62\x65\x20\x6d\x75\x63\x68\x20\x73\x65"
+	"\x6e\x73\x65\x20\x69\x6e\x0a\x63\x6f\x6d\x70\x72\x65\x73\x73\x69"
+	"\x6e\x67\x20\x6d\x65\x20\x69\x6e\x20\x74\x68\x65\x20\x66\x69\x72"
+	"\x73\x74\x20\x70\x6c\x61\x63\x65\x2e\x20\x41\x74\x20\x6c\x65\x61"
+	"\x73\x74\x20\x77\x69\x74\x68\x20\x6c\x7a\x6f\x2c\x20\x61\x6e\x79"
+	"\x77\x61\x79\x2c\x0a\x77\x68\x69\x63\x68\x20\x61\x70\x70\x65\x61"
+	"\x72\x73\x20\x74\x6f\x20\x62\x65\x68\x61\x76\x65\x20\x70\x6f\x6f"
+	"\x72\x6c\x79\x20\x69\x6e\x20\x74\x68\x65\x20\x66\x61\x63\x65\x20"
+	"\x6f\x66\x20\x73\x68\x6f\x72\x74\x20\x74\x65\x78\x74\x0a\x6d\x65"
+	"\x73\x73\x61\x67\x65\x73\x2e\x0a\xe4\xf4\x6e\xfa";
+static const unsigned long zstd_compressed_size = 364;
 
 #define TEST_BUFFER_SIZE	512
 
@@ -157,6 +187,41 @@ static int uncompress_using_gzip(struct unit_test_state *uts,
 	return ret;
 }
 
+struct gzip_stream_priv {
+	unsigned char *data;
+	ulong left;
+};
+
+/* Hand out data in small pieces to exercise chunk boundaries */
+static long gzip_stream_read(void *priv, void *buf, ulong size)
+{
+	struct gzip_stream_priv *rd = priv;
+	ulong len = min(min(size, rd->left), 7UL);
+
+	memcpy(buf, rd->data, len);
+	rd->data += len;
+	rd->left -= len;
+
+	return len;
+}
+
+static int uncompress_using_gzip_stream(struct unit_test_state *uts,
+					void *in, unsigned long in_size,
+					void *out, unsigned long out_max,
+					unsigned long *out_size)
+{
+	struct gzip_stream_priv rd = { .data = in, .left = in_size };
+	unsigned long len = 0;
+	int ret;
+
+	/* Use a buffer smaller than the gzip header, which must still work */
+	ret = gunzip_stream(out, out_max, gzip_stream_read, &rd, 8, &len);
+	if (out_size)
+		*out_size = len;
+
+	return ret;
+}
+
 static int compress_using_bzip2(struct unit_test_state *uts,
 				void *in, unsigned long in_size,
 				void *out, unsigned long out_max,
@@ -296,6 +361,25 @@ static int uncompress_using_lz4(struct unit_test_state *uts,
 	return (ret != 0);
 }
 
+static int compress_using_zstd(struct unit_test_state *uts,
+			       void *in, unsigned long in_size,
+			       void *out, unsigned long out_max,
+			       unsigned long *out_size)
+{
+	/* There is no zstd compression in u-boot, so fake it. */
+	ut_asserteq(in_size, strlen(plain));
+	ut_asserteq_mem(plain, in, in_size);
+
+	if (zstd_compressed_size > out_max)
+		return -1;
+
+	memcpy(out, zstd_compressed, zstd_compressed_size);
+	if (out_size)
+		*out_size = zstd_compressed_size;
+
+	return 0;
+}
+
 #define errcheck(statement) if (!(statement)) { \
 	fprintf(stderr, "\tFailed: %s\n", #statement); \
 	ret = 1; \
@@ -414,6 +498,113 @@ static int compression_test_gzip(struct unit_test_state *uts)
 }
 COMPRESSION_TEST(compression_test_gzip, 0);
 
+static int compression_test_gzip_stream(struct unit_test_state *uts)
+{
+	return run_test(uts, "gzip_stream", compress_using_gzip,
+			uncompress_using_gzip_stream);
+}
+COMPRESSION_TEST(compression_test_gzip_stream, 0);
+
+#define GZIP_SPEED_SIZE		(256 << 10)
+
+static void *gzip_speed_alloc(void *x, unsigned int items, unsigned int size)
+{
+	return malloc(items * size);
+}
+
+static void gzip_speed_free(void *x, void *addr, unsigned int nb)
+{
+	free(addr);
+}
+
+static uint gzip_speed_rand(uint *seed)
+{
+	*seed = *seed * 1103515245 + 12345;
+
+	return *seed >> 16;
+}
+
+/*
+ * Decompress a larger buffer of literals and matches at a range of distances
+ * with gunzip(), which spends nearly all its time in inflate_fast(), and by
+ * feeding inflate() a byte at a time, which never enters it. The output of
+ * both must match the input and the throughput of each is reported.
+ */
+static int compression_test_gzip_speed(struct unit_test_state *uts)
+{
+	static const uint dists[] = { 1, 2, 3, 5, 8, 13, 31, 250, 4000 };
+	unsigned char *orig, *comp, *out;
+	unsigned long comp_size, len;
+	ulong start, fast_us, slow_us;
+	uint seed = 1, pos = 0;
+	int offset, ret;
+	z_stream s;
+
+	orig = malloc(GZIP_SPEED_SIZE);
+	ut_assertnonnull(orig);
+	comp = malloc(GZIP_SPEED_SIZE);
+	ut_assertnonnull(comp);
+	out = malloc(GZIP_SPEED_SIZE);
+	ut_assertnonnull(out);
+
+	while (pos < GZIP_SPEED_SIZE) {
+		uint dist, n;
+
+		n = gzip_speed_rand(&seed) % 200 + 3;
+		n = min(n, GZIP_SPEED_SIZE - pos);
+		dist = dists[gzip_speed_rand(&seed) % ARRAY_SIZE(dists)];
+		if (!(gzip_speed_rand(&seed) % 4) || dist > pos) {
+			for (; n; n--, pos++)
+				orig[pos] = gzip_speed_rand(&seed);
+		} else {
+			for (; n; n--, pos++)
+				orig[pos] = orig[pos - dist];
+		}
+	}
+
+	comp_size = GZIP_SPEED_SIZE;
+	ut_assertok(gzip(comp, &comp_size, orig, GZIP_SPEED_SIZE));
+
+	start = timer_get_us();
+	len = comp_size;
+	ut_assertok(gunzip(out, GZIP_SPEED_SIZE, comp, &len));
+	fast_us = max(timer_get_us() - start, 1UL);
+	ut_asserteq(GZIP_SPEED_SIZE, len);
+	ut_asserteq_mem(orig, out, GZIP_SPEED_SIZE);
+
+	memset(out, '\0', GZIP_SPEED_SIZE);
+	offset = gzip_parse_header(comp, comp_size);
+	ut_assert(offset > 0);
+	memset(&s, '\0', sizeof(s));
+	s.zalloc = gzip_speed_alloc;
+	s.zfree = gzip_speed_free;
+	ut_asserteq(Z_OK, inflateInit2(&s, -MAX_WBITS));
+	s.next_in = comp + offset;
+	s.next_out = out;
+	s.avail_out = GZIP_SPEED_SIZE;
+	start = timer_get_us();
+	do {
+		s.avail_in = 1;
+		ret = inflate(&s, Z_SYNC_FLUSH);
+	} while (ret == Z_OK);
+	slow_us = max(timer_get_us() - start, 1UL);
+	inflateEnd(&s);
+	ut_asserteq(Z_STREAM_END, ret);
+	ut_asserteq(GZIP_SPEED_SIZE, s.total_out);
+	ut_asserteq_mem(orig, out, GZIP_SPEED_SIZE);
+
+	printf("\tgunzip %lu KiB/s, without inflate_fast %lu KiB/s\n",
+	       GZIP_SPEED_SIZE / 1024 * 1000000UL / fast_us,
+	       GZIP_SPEED_SIZE / 1024 * 1000000UL / slow_us);
+
+	free(out);
+	free(comp);
+	free(orig);
+
+	return 0;
+}
+COMPRESSION_TEST(compression_test_gzip_speed, 0);
+
 static int compression_test_bzip2(struct unit_test_state *uts)
 {
 	return run_test(uts, "bzip2", compress_using_bzip2,
@@ -440,6 +631,44 @@ static int compression_test_lz4(struct unit_test_state *uts)
 }
 COMPRESSION_TEST(compression_test_lz4, 0);
 
+/* Two lz4 frames with a skippable frame between them */
+static int compression_test_lz4_multi_frame(struct unit_test_state *uts)
+{
+	static const u32 skippable[] = {
+		cpu_to_le32(0x184d2a5a), cpu_to_le32(4), 0xdeadbeef
+	};
+	ulong plain_size = strlen(plain);
+	char *in, *out;
+	size_t in_size, out_size;
+
+	in_size = 2 * lz4_compressed_size + sizeof(skippable);
+	in = malloc(in_size);
+	ut_assertnonnull(in);
+	out = malloc(2 * plain_size);
+	ut_assertnonnull(out);
+
+	memcpy(in, lz4_compressed, lz4_compressed_size);
+	memcpy(in + lz4_compressed_size, skippable, sizeof(skippable));
+	memcpy(in + lz4_compressed_size + sizeof(skippable), lz4_compressed,
+	       lz4_compressed_size);
+
+	out_size = 2 * plain_size;
+	ut_assertok(ulz4fn(in, in_size, out, &out_size));
+	ut_asserteq(2 * plain_size, out_size);
+	ut_asserteq_mem(plain, out, plain_size);
+	ut_asserteq_mem(plain, out + plain_size, plain_size);
+
+	/* A truncated second frame must be reported */
+	out_size = 2 * plain_size;
+	ut_assert(ulz4fn(in, in_size - 1, out, &out_size) < 0);
+
+	free(out);
+	free(in);
+
+	return 0;
+}
+COMPRESSION_TEST(compression_test_lz4_multi_frame, 0);
+
 static int compress_using_none(struct unit_test_state *uts,
 			       void *in, unsigned long in_size,
 			       void *out, unsigned long out_max,
@@ -530,6 +759,12 @@ static int compression_test_bootm_lz4(struct unit_test_state *uts)
 }
 COMPRESSION_TEST(compression_test_bootm_lz4, 0);
 
+static int compression_test_bootm_zstd(struct unit_test_state *uts)
+{
+	return run_bootm_test(uts, IH_COMP_ZSTD, compress_using_zstd);
+}
+COMPRESSION_TEST(compression_test_bootm_zstd, 0);
+
 static int compression_test_bootm_none(struct unit_test_state *uts)
 {
 	return run_bootm_test(uts, IH_COMP_NONE, compress_using_none);
@@ -57,3 +57,48 @@ static int dm_test_fdtdec_set_carveout(struct unit_test_state *uts)
 }
 DM_TEST(dm_test_fdtdec_set_carveout,
 	DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT | DM_TESTF_FLAT_TREE);
+
+static int dm_test_fdtdec_phandle_index(struct unit_test_state *uts)
+{
+	const void *old_blob = gd->fdt_blob;
+	char path[256];
+	void *blob;
+	int blob_sz, offset, node = -1;
+	u32 phandle = 0;
+
+	/* Every phandle must resolve exactly as libfdt does it */
+	for (offset = fdt_next_node(old_blob, -1, NULL); offset >= 0;
+	     offset = fdt_next_node(old_blob, offset, NULL)) {
+		u32 val = fdt_get_phandle(old_blob, offset);
+
+		if (!val)
+			continue;
+		ut_asserteq(offset, fdtdec_node_offset_by_phandle(old_blob, val));
+		node = offset;
+		phandle = val;
+	}
+	ut_assert(node > 0);
+	ut_asserteq(-FDT_ERR_NOTFOUND,
+		    fdtdec_node_offset_by_phandle(old_blob, 0xfffffff0));
+	ut_assertok(fdt_get_path(old_blob, node, path, sizeof(path)));
+
+	/* Use a writable copy as the control FDT and shift its nodes */
+	blob_sz = fdt_totalsize(old_blob) + 4096;
+	blob = malloc(blob_sz);
+	ut_assertnonnull(blob);
+	ut_assertok(fdt_open_into(old_blob, blob, blob_sz));
+	gd->fdt_blob = blob;
+
+	ut_asserteq(fdt_path_offset(blob, path),
+		    fdtdec_node_offset_by_phandle(blob, phandle));
+	ut_assert(fdt_add_subnode(blob, 0, "phandle-index-test") > 0);
+	offset = fdt_path_offset(blob, path);
+	ut_assert(offset != node);
+	ut_asserteq(offset, fdtdec_node_offset_by_phandle(blob, phandle));
+
+	gd->fdt_blob = old_blob;
+	free(blob);
+
+	return 0;
+}
+DM_TEST(dm_test_fdtdec_phandle_index, DM_TESTF_SCAN_FDT);
@@ -3,8 +3,12 @@
 #include <common.h>
 #include <dm.h>
 #include <log.h>
+#include <malloc.h>
+#include <of_live.h>
+#include <dm/of_access.h>
 #include <dm/of_extra.h>
 #include <dm/test.h>
+#include <linux/libfdt.h>
 #include <test/ut.h>
 
 static int dm_test_ofnode_compatible(struct unit_test_state *uts)
@@ -135,3 +139,74 @@ static int dm_test_ofnode_get_child_count(struct unit_test_state *uts)
 }
 DM_TEST(dm_test_ofnode_get_child_count,
 	DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT);
+
+#ifdef CONFIG_OF_LIVE
+/* Number of nested nodes in a tree too deep to size from its tags */
+#define DEEP_TREE_DEPTH		100
+
+static int dm_test_ofnode_unflatten(struct unit_test_state *uts)
+{
+	struct device_node *root, *np;
+	const struct property *pp;
+	char fdt[4096] __aligned(8), data[256];
+	unsigned long size;
+	int i, len;
+
+	/*
+	 * A large property value stays in the blob, so only the nodes and
+	 * property headers are counted when sizing the tree from its tags
+	 */
+	memset(data, 0xa5, sizeof(data));
+	ut_assertok(fdt_create(fdt, sizeof(fdt)));
+	ut_assertok(fdt_finish_reservemap(fdt));
+	ut_assertok(fdt_begin_node(fdt, ""));
+	ut_assertok(fdt_begin_node(fdt, "big"));
+	ut_assertok(fdt_property(fdt, "data", data, sizeof(data)));
+	ut_assertok(fdt_end_node(fdt));
+	ut_assertok(fdt_end_node(fdt));
+	ut_assertok(fdt_finish(fdt));
+
+	size = unflatten_device_tree_size(fdt);
+	ut_assert(size);
+	ut_assert(size < 2 * sizeof(struct device_node) +
+		  3 * sizeof(struct property) + 64);
+	ut_assertok(unflatten_device_tree(fdt, &root));
+	np = root->child;
+	ut_assertnonnull(np);
+	ut_asserteq_str("/big", np->full_name);
+	pp = of_find_property(np, "data", &len);
+	ut_assertnonnull(pp);
+	ut_asserteq(sizeof(data), len);
+	ut_assertok(memcmp(data, pp->value, sizeof(data)));
+	free(root);
+
+	/*
+	 * A deeply nested tree cannot be sized from its tags, so it is sized
+	 * by a separate pass over its nodes
+	 */
+	ut_assertok(fdt_create(fdt, sizeof(fdt)));
+	ut_assertok(fdt_finish_reservemap(fdt));
+	ut_assertok(fdt_begin_node(fdt, ""));
+	for (i = 0; i < DEEP_TREE_DEPTH; i++)
+		ut_assertok(fdt_begin_node(fdt, "n"));
+	for (i = 0; i < DEEP_TREE_DEPTH; i++)
+		ut_assertok(fdt_end_node(fdt));
+	ut_assertok(fdt_end_node(fdt));
+	ut_assertok(fdt_finish(fdt));
+
+	ut_asserteq(0, unflatten_device_tree_size(fdt));
+	ut_assertok(unflatten_device_tree(fdt, &root));
+	np = root;
+	for (i = 0; i < DEEP_TREE_DEPTH; i++) {
+		np = np->child;
+		ut_assertnonnull(np);
+		ut_asserteq_str("n", np->name);
+		ut_asserteq(2 * (i + 1), strlen(np->full_name));
+	}
+	ut_assertnull(np->child);
+	free(root);
+
+	return 0;
+}
+DM_TEST(dm_test_ofnode_unflatten, 0);
+#endif
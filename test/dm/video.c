@@ -13,6 +13,7 @@
 #include <os.h>
 #include <video.h>
 #include <video_console.h>
+#include <dm/device-internal.h>
 #include <dm/test.h>
 #include <dm/uclass-internal.h>
 #include <test/ut.h>
@@ -184,6 +185,110 @@ static int dm_test_video_ansi(struct unit_test_state *uts)
 DM_TEST(dm_test_video_ansi, DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT);
 #endif
 
+/* Test that a sync only covers the lines which have changed */
+static int dm_test_video_damage(struct unit_test_state *uts)
+{
+	struct video_priv *priv;
+	struct udevice *dev, *con;
+
+	ut_assertok(select_vidconsole(uts, "vidconsole0"));
+	ut_assertok(uclass_get_device(UCLASS_VIDEO, 0, &dev));
+	ut_assertok(uclass_get_device(UCLASS_VIDEO_CONSOLE, 0, &con));
+	priv = dev_get_uclass_priv(dev);
+
+	/* The whole display is cleared on probe */
+	ut_asserteq(0, priv->damage_ystart);
+	ut_asserteq(768, priv->damage_yend);
+	video_sync(dev, true);
+	ut_asserteq(0, priv->damage_yend);
+
+	/* Writing a character affects only its text row */
+	vidconsole_position_cursor(con, 0, 2);
+	ut_assertok(vidconsole_put_char(con, 'a'));
+	ut_asserteq(2 * 16, priv->damage_ystart);
+	ut_asserteq(3 * 16, priv->damage_yend);
+
+	/* Damage is merged and clipped to the display */
+	video_damage(dev, 700, 100);
+	ut_asserteq(2 * 16, priv->damage_ystart);
+	ut_asserteq(768, priv->damage_yend);
+	video_sync(dev, true);
+	ut_asserteq(0, priv->damage_yend);
+
+	return 0;
+}
+DM_TEST(dm_test_video_damage, DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT);
+
+/**
+ * scroll_text() - Write enough text to scroll the display several times
+ *
+ * @uts:	Test state
+ * @pan:	true to scroll by panning the display, false to copy it
+ * @return compressed size of the frame buffer, or -ve on error
+ */
+static int scroll_text(struct unit_test_state *uts, bool pan)
+{
+	struct sandbox_sdl_plat *plat;
+	struct video_priv *priv;
+	struct udevice *dev, *con;
+	int i;
+
+	ut_assertok(select_vidconsole(uts, "vidconsole0"));
+	ut_assertok(uclass_find_device(UCLASS_VIDEO, 0, &dev));
+	plat = dev_get_platdata(dev);
+	plat->pan = pan;
+	ut_assertok(uclass_get_device(UCLASS_VIDEO, 0, &dev));
+	ut_assertok(uclass_get_device(UCLASS_VIDEO_CONSOLE, 0, &con));
+	priv = dev_get_uclass_priv(dev);
+	ut_asserteq(pan ? 768 : 0, priv->pan_lines);
+
+	for (i = 0; i < SCROLL_LINES; i++) {
+		vidconsole_put_char(con, 'A' + i % 50);
+		vidconsole_put_char(con, '\n');
+	}
+
+	return compress_frame_buffer(dev);
+}
+
+/* Test that scrolling by panning gives the same display as copying */
+static int dm_test_video_pan(struct unit_test_state *uts)
+{
+	struct video_priv *priv;
+	struct udevice *dev, *con;
+	int size;
+
+	size = scroll_text(uts, false);
+	ut_assert(size > 0);
+	ut_assertok(uclass_get_device(UCLASS_VIDEO, 0, &dev));
+	priv = dev_get_uclass_priv(dev);
+	ut_asserteq_ptr(priv->fb_base, priv->fb);
+	ut_assertok(device_remove(dev, DM_REMOVE_NORMAL));
+
+	ut_asserteq(size, scroll_text(uts, true));
+
+	/*
+	 * The display scrolls 53 times: it pans 48 times, is then copied back
+	 * to the start of memory, then pans another 4 times
+	 */
+	ut_assertok(uclass_get_device(UCLASS_VIDEO, 0, &dev));
+	priv = dev_get_uclass_priv(dev);
+	ut_asserteq_ptr(priv->fb_base + 4 * 16 * priv->line_length, priv->fb);
+
+	/* Unpanning moves the display back to the start without changing it */
+	ut_assertok(video_unpan(dev));
+	ut_asserteq_ptr(priv->fb_base, priv->fb);
+	ut_asserteq(0, priv->pan_lines);
+	ut_asserteq(size, compress_frame_buffer(dev));
+
+	/* Later scrolling copies the display instead of panning */
+	ut_assertok(uclass_get_device(UCLASS_VIDEO_CONSOLE, 0, &con));
+	vidconsole_put_char(con, '\n');
+	ut_asserteq_ptr(priv->fb_base, priv->fb);
+
+	return 0;
+}
+DM_TEST(dm_test_video_pan, DM_TESTF_SCAN_PDATA | DM_TESTF_SCAN_FDT);
+
 /**
  * check_vidconsole_output() - Run a text console test
  *
@@ -0,0 +1,48 @@
+# SPDX-License-Identifier: GPL-2.0+
+#
+# Test the bootstage command
+
+import json
+import pytest
+import u_boot_utils
+
+@pytest.mark.buildconfigspec('cmd_bootstage')
+def test_bootstage_report(u_boot_console):
+    """Test that the report shows the boot stages recorded so far."""
+    output = u_boot_console.run_command('bootstage report')
+    assert 'Timer summary in microseconds' in output
+    assert 'reset' in output
+    assert 'Accumulated time:' in output
+
+@pytest.mark.buildconfigspec('cmd_bootstage')
+def test_bootstage_export_json(u_boot_console):
+    """Test exporting the bootstage data as JSON on the console."""
+    output = u_boot_console.run_command('bootstage export json')
+    data = json.loads(output)
+    marks = [rec['name'] for rec in data['records'] if rec['type'] == 'mark']
+    assert 'reset' in marks
+
+    span_count = u_boot_console.config.buildconfig.get(
+        'config_bootstage_span_count', '0')
+    if int(span_count):
+        probes = [span for span in data['spans'] if span['type'] == 'probe']
+        assert probes
+        for span in data['spans']:
+            assert span['parent'] < span['id']
+
+@pytest.mark.buildconfigspec('cmd_bootstage')
+def test_bootstage_export_csv(u_boot_console):
+    """Test exporting the bootstage data as CSV, to the console and memory."""
+    output = u_boot_console.run_command('bootstage export csv')
+    lines = output.splitlines()
+    assert lines[0] == 'type,id,parent,name,start_us,time_us,count'
+    assert 'mark,' in output
+
+    addr = '%x' % u_boot_utils.find_ram_base(u_boot_console)
+    u_boot_console.run_command('setenv filesize')
+    u_boot_console.run_command('bootstage export csv %s 10000' % addr)
+    output = u_boot_console.run_command('printenv filesize')
+    assert int(output.split('=')[1], 16) > len(lines[0])
+
+    output = u_boot_console.run_command('bootstage export csv %s 10' % addr)
+    assert 'Not enough space' in output
@@ -0,0 +1,98 @@
+# SPDX-License-Identifier:      GPL-2.0+
+#
+# U-Boot File System: BTRFS Test
+
+"""
+This test verifies partial reads of compressed BTRFS files and checks that a
+second read from the same compressed extent uses the cached, decompressed
+copy of it.
+"""
+
+import base64
+import hashlib
+import os
+import pytest
+import re
+import shutil
+from subprocess import check_call, CalledProcessError
+from fstest_defs import ADDR
+
+# BTRFS compresses files in extents of up to 128KiB of data
+EXTENT_SIZE = 128 * 1024
+
+def make_file(fname):
+    """Create a file which compresses to about three quarters of its size.
+
+    Args:
+        fname: File to create.
+
+    Return:
+        The contents of the file.
+    """
+    data = base64.b64encode(os.urandom(EXTENT_SIZE * 3 // 4))
+    with open(fname, 'wb') as fd:
+        fd.write(data)
+    return data
+
+def blk_read_bytes(u_boot_console, cmd):
+    """Run a command and get the number of bytes it read from block devices.
+
+    Args:
+        u_boot_console: U-Boot console.
+        cmd: Command to run.
+
+    Return:
+        The number of bytes read.
+    """
+    u_boot_console.run_command('perf reset')
+    u_boot_console.run_command(cmd)
+    output = u_boot_console.run_command('perf show')
+    match = re.search(r'blk\s+read_bytes\s+([\d,]+)', output)
+    assert match
+    return int(match.group(1).replace(',', ''))
+
+@pytest.fixture(scope='module')
+def btrfs_image(u_boot_config):
+    """Set up a BTRFS image holding a compressed file.
+
+    Return:
+        A tuple of the image file name and the contents of /data.
+    """
+    if not u_boot_config.buildconfig.get('config_fs_btrfs', None):
+        pytest.skip('BTRFS is not enabled')
+    if not shutil.which('mkfs.btrfs'):
+        pytest.skip('mkfs.btrfs is not available')
+
+    base = u_boot_config.persistent_data_dir + '/btrfs_src'
+    img = u_boot_config.persistent_data_dir + '/btrfs.img'
+    shutil.rmtree(base, ignore_errors=True)
+    os.makedirs(base)
+    data = make_file(base + '/data')
+    check_call('dd if=/dev/zero of=%s bs=1M count=128' % img, shell=True)
+    try:
+        check_call('mkfs.btrfs -f --rootdir %s --compress zlib %s'
+                   % (base, img), shell=True)
+    except CalledProcessError:
+        pytest.skip('mkfs.btrfs cannot create compressed images')
+    yield img, data
+    shutil.rmtree(base, ignore_errors=True)
+    os.remove(img)
+
+@pytest.mark.boardspec('sandbox')
+@pytest.mark.buildconfigspec('cmd_perf')
+@pytest.mark.slow
+def test_btrfs_partial(u_boot_console, btrfs_image):
+    """Read two ranges of one compressed extent with separate commands."""
+    img, data = btrfs_image
+    u_boot_console.run_command('host bind 0 %s' % img)
+
+    read_bytes = []
+    for offset, size in [(0x1000, 0x2000), (0x9000, 0x3000)]:
+        cmd = 'load host 0 %x /data %x %x' % (ADDR, size, offset)
+        read_bytes.append(blk_read_bytes(u_boot_console, cmd))
+        output = u_boot_console.run_command('md5sum %x %x' % (ADDR, size))
+        expect = hashlib.md5(data[offset:offset + size]).hexdigest()
+        assert expect in output
+
+    # The second read must not read the compressed extent again
+    assert read_bytes[1] < read_bytes[0] - EXTENT_SIZE // 2
@@ -0,0 +1,46 @@
+# SPDX-License-Identifier:      GPL-2.0+
+#
+# U-Boot File System: gzload Test
+
+"""
+This test verifies that the gzload command decompresses a gzipped file which
+is larger than the chunk it reads at a time.
+"""
+
+import gzip
+import hashlib
+import os
+import pytest
+from fstest_defs import ADDR
+
+# Larger than the 256KiB that gzload reads at a time, even once compressed
+DATA_SIZE = 1024 * 1024
+
+@pytest.mark.boardspec('sandbox')
+@pytest.mark.buildconfigspec('cmd_gzload')
+def test_gzload(u_boot_console, u_boot_config):
+    """Load a gzipped file from hostfs and check its contents."""
+    fname = u_boot_config.persistent_data_dir + '/gzload.gz'
+    data = os.urandom(DATA_SIZE // 2) + bytes(DATA_SIZE // 2)
+    with gzip.open(fname, 'wb') as fd:
+        fd.write(data)
+
+    output = u_boot_console.run_command('gzload hostfs - %x %s' %
+                                        (ADDR, fname))
+    assert '%d bytes uncompressed' % DATA_SIZE in output
+    output = u_boot_console.run_command('printenv filesize')
+    assert 'filesize=%x' % DATA_SIZE in output
+    output = u_boot_console.run_command('md5sum %x %x' % (ADDR, DATA_SIZE))
+    assert hashlib.md5(data).hexdigest() in output
+
+    # A buffer which is too small must be reported as an error
+    output = u_boot_console.run_command('gzload hostfs - %x %s %x; echo rc=$?'
+                                        % (ADDR, fname, DATA_SIZE // 2))
+    assert 'rc=1' in output
+
+    # So must a buffer which runs past the end of memory
+    output = u_boot_console.run_command('gzload hostfs - %x %s %x; echo rc=$?'
+                                        % (ADDR, fname, 0x7fffffff))
+    assert 'would overwrite reserved memory' in output
+    assert 'rc=1' in output
+    os.remove(fname)
@@ -0,0 +1,134 @@
+# SPDX-License-Identifier:      GPL-2.0+
+#
+# U-Boot File System: SquashFS Test
+
+"""
+This test verifies read access to SquashFS images with the generic ls, size
+and load commands, for each compressor that mksquashfs and U-Boot support.
+"""
+
+import os
+import pytest
+import shutil
+from subprocess import check_call, check_output, CalledProcessError
+from fstest_defs import ADDR
+
+SQFS_COMPRESSORS = ['gzip', 'lzma', 'lzo', 'lz4', 'zstd']
+
+def make_tree(base):
+    """Create the files to put into the image.
+
+    Args:
+        base: Directory to populate.
+
+    Return:
+        A dict mapping the paths to test, relative to the root of the image,
+        to the MD5 hash of their contents.
+    """
+    os.makedirs(base + '/boot')
+    os.makedirs(base + '/many')
+    os.makedirs(base + '/names')
+    check_call('dd if=/dev/urandom of=%s/boot/Image bs=1M count=3'
+               % base, shell=True)
+    # A file with a tail end in a fragment block
+    check_call('dd if=/dev/urandom of=%s/boot/dtb bs=1000 count=33'
+               % base, shell=True)
+    os.symlink('Image', base + '/boot/vmlinuz')
+    os.symlink('boot', base + '/lnk')
+    # Enough entries for mksquashfs to add a directory index
+    for i in range(1000):
+        with open('%s/many/file%04d' % (base, i), 'w') as fd:
+            fd.write('%d\n' % i)
+
+    # Names with a byte of 0x80 or more sort after plain ASCII
+    for name in ['A', 'z', '\u00e9']:
+        with open('%s/names/%s' % (base, name), 'w') as fd:
+            fd.write('%s\n' % name)
+
+    md5 = {}
+    for path in ['boot/Image', 'boot/dtb', 'many/file0999', 'names/A',
+                 'names/\u00e9']:
+        out = check_output('md5sum %s/%s' % (base, path), shell=True)
+        md5[path] = out.decode().split()[0]
+    md5['boot/vmlinuz'] = md5['boot/Image']
+    md5['lnk/dtb'] = md5['boot/dtb']
+    return md5
+
+@pytest.fixture(scope='module', params=SQFS_COMPRESSORS)
+def sqfs_image(request, u_boot_config):
+    """Set up a SquashFS image compressed with the requested compressor.
+
+    Return:
+        A tuple of the image file name and the dict from make_tree().
+    """
+    if not u_boot_config.buildconfig.get('config_fs_squashfs', None):
+        pytest.skip('SquashFS is not enabled')
+    if not shutil.which('mksquashfs'):
+        pytest.skip('mksquashfs is not available')
+    comp = request.param
+    lib = {'gzip': 'zlib', 'lzma': 'lzma', 'lzo': 'lzo', 'lz4': 'lz4',
+           'zstd': 'zstd'}[comp]
+    if not u_boot_config.buildconfig.get('config_%s' % lib, None):
+        pytest.skip('%s is not enabled' % lib)
+
+    base = u_boot_config.persistent_data_dir + '/sqfs_src'
+    img = u_boot_config.persistent_data_dir + '/sqfs_%s.img' % comp
+    shutil.rmtree(base, ignore_errors=True)
+    md5 = make_tree(base)
+    try:
+        check_call('mksquashfs %s %s -noappend -comp %s'
+                   % (base, img, comp), shell=True)
+    except CalledProcessError:
+        pytest.skip('mksquashfs cannot create %s images' % comp)
+    yield img, md5
+    shutil.rmtree(base, ignore_errors=True)
+    os.remove(img)
+
+@pytest.mark.boardspec('sandbox')
+@pytest.mark.slow
+def test_squashfs_load(u_boot_console, sqfs_image):
+    """Load files, also through symlinks, and check their contents."""
+    img, md5 = sqfs_image
+    u_boot_console.run_command('host bind 0 %s' % img)
+    for path, val in md5.items():
+        output = u_boot_console.run_command_list([
+            'load host 0 %x /%s' % (ADDR, path),
+            'md5sum %x $filesize' % ADDR])
+        assert val in ''.join(output)
+
+    output = u_boot_console.run_command_list([
+        'load host 0 %x /boot/Image 0x1000 0x12345' % ADDR,
+        'printenv filesize'])
+    assert 'filesize=1000' in ''.join(output)
+
+    output = u_boot_console.run_command('load host 0 %x /nope' % ADDR)
+    assert 'Failed to load' in output
+
+@pytest.mark.boardspec('sandbox')
+@pytest.mark.slow
+def test_squashfs_ls(u_boot_console, sqfs_image):
+    """List directories and check for files."""
+    img, md5 = sqfs_image
+    u_boot_console.run_command('host bind 0 %s' % img)
+    output = u_boot_console.run_command('ls host 0 /')
+    assert 'boot/' in output
+    assert '0 dir(s)' not in output
+
+    output = u_boot_console.run_command('ls host 0 /many')
+    assert '1000 file(s), 0 dir(s)' in output
+
+    output = u_boot_console.run_command('size host 0 /boot/dtb')
+    output = u_boot_console.run_command('printenv filesize')
+    assert 'filesize=80e8' in output
+
+    output = u_boot_console.run_command(
+        'test -e host 0 /many/file0500 && echo yes')
+    assert 'yes' in output
+    output = u_boot_console.run_command(
+        'test -e host 0 /many/file1000 || echo no')
+    assert 'no' in output
+
+    for name in ['A', 'z', '\u00e9']:
+        output = u_boot_console.run_command(
+            'test -e host 0 /names/%s && echo yes' % name)
+        assert 'yes' in output
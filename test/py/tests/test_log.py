@@ -130,3 +130,20 @@ def test_log_format(u_boot_console):
         run_with_format('FLfm', 'file.c:123-func() msg')
         run_with_format('lm', 'NOTICE. msg')
         run_with_format('m', 'msg')
+
+@pytest.mark.buildconfigspec('cmd_log')
+@pytest.mark.buildconfigspec('log_buf')
+def test_log_dump(u_boot_console):
+    """Test that records are kept in the log buffer even if not shown"""
+    cons = u_boot_console
+    with cons.log.section('dump'):
+        cons.run_command('log format all')
+        cons.run_command('log level %d' % LOGL_WARNING)
+        output = cons.run_command(
+            'log rec arch info file.c 123 func hidden-msg')
+        assert output == ''
+        cons.run_command('log level %d' % LOGL_INFO)
+
+        output = cons.run_command('log dump')
+        assert 'INFO.arch,file.c:123-func() hidden-msg' in output
+        cons.run_command('log format default')
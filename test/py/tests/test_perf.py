@@ -0,0 +1,77 @@
+# SPDX-License-Identifier: GPL-2.0+
+#
+# Test the perf command
+
+import json
+import os
+import pytest
+import re
+
+def get_counters(output):
+    """Get the counters from the output of 'perf show'.
+
+    Args:
+        output: Output of the command.
+
+    Return:
+        Dict of counter values, keyed by (subsystem, counter) tuples.
+    """
+    counters = {}
+    for line in output.splitlines():
+        match = re.match(r'(\w+)\s+(\w+)\s+([\d,]+)$', line.strip())
+        if match:
+            key = (match.group(1), match.group(2))
+            counters[key] = int(match.group(3).replace(',', ''))
+    return counters
+
+@pytest.mark.buildconfigspec('cmd_perf')
+def test_perf_show_reset(u_boot_console):
+    """Test that the counters are shown and can be reset."""
+    u_boot_console.run_command('perf reset')
+    output = u_boot_console.run_command('perf show')
+    lines = output.splitlines()
+    assert lines[0].split() == ['Subsys', 'Counter', 'Value']
+
+@pytest.mark.buildconfigspec('cmd_perf')
+def test_perf_stat(u_boot_console):
+    """Test running a command and showing its counters."""
+    output = u_boot_console.run_command('perf stat echo perf-test')
+    assert 'perf-test' in output
+    assert 'Elapsed:' in output
+    assert 'Subsys' in output
+
+    output = u_boot_console.run_command('perf stat')
+    assert 'Usage:' in output
+
+@pytest.mark.buildconfigspec('cmd_perf')
+@pytest.mark.buildconfigspec('cmd_bootstage')
+def test_perf_bootstage_export(u_boot_console):
+    """Test that the counters are included in the bootstage export."""
+    output = u_boot_console.run_command('bootstage export json')
+    data = json.loads(output)
+    assert 'malloc.allocs' in data['counters']
+    assert data['counters']['malloc.allocs'] > 0
+
+@pytest.mark.boardspec('sandbox')
+@pytest.mark.buildconfigspec('cmd_perf')
+def test_perf_blk(u_boot_console):
+    """Test that block reads are counted, then cleared by a reset."""
+    fname = os.path.join(u_boot_console.config.persistent_data_dir, 'perf.img')
+    with open(fname, 'wb') as fd:
+        fd.write(bytes(1024 * 1024))
+    u_boot_console.run_command('host bind 0 %s' % fname)
+
+    # Looking for a filesystem reads the first blocks of the device
+    u_boot_console.run_command('perf reset')
+    u_boot_console.run_command('ls host 0')
+    counters = get_counters(u_boot_console.run_command('perf show'))
+    assert counters.get(('blk', 'reads'), 0) > 0
+    assert counters.get(('blk', 'read_bytes'), 0) > 0
+
+    u_boot_console.run_command('perf reset')
+    counters = get_counters(u_boot_console.run_command('perf show'))
+    assert ('blk', 'reads') not in counters
+    assert ('blk', 'read_bytes') not in counters
+
+    u_boot_console.run_command('host bind 0')
+    os.remove(fname)
@@ -27,6 +27,41 @@ reset
 END
 }
 
+# Change the depth limit while functions are running, then write the call
+# trace to a file. The first argument is the first depth command to run.
+run_depth_trace() {
+	./${OUTPUT_DIR}/u-boot <<END
+$1
+hash sha256 0 10000
+setenv raise 'trace depth 15'
+run raise
+trace pause
+trace calls 1000000 1000000
+save hostfs - 1000000 $2 \${profoffset}
+reset
+END
+}
+
+# Get the number of unmatched entries and exits in a call trace file
+trace_balance() {
+	./${OUTPUT_DIR}/tools/proftool -v3 -m ${OUTPUT_DIR}/System.map -p $1 \
+		dump-ftrace 2>&1 >/dev/null | grep "call trace:.*without"
+}
+
+# A trace where the depth limit is lowered and then raised again (from a
+# deeper call) must be as balanced as one where the limit does not change
+check_depth_change() {
+	echo "Check depth change"
+	run_depth_trace "trace depth 15" ${tmp}.same >/dev/null
+	run_depth_trace "trace depth 2" ${tmp}.changed >/dev/null
+	same="$(trace_balance ${tmp}.same)"
+	changed="$(trace_balance ${tmp}.changed)"
+	rm -f ${tmp}.same ${tmp}.changed
+	if [ -z "${same}" ] || [ "${same}" != "${changed}" ]; then
+		fail "unbalanced trace after depth change: ${changed}"
+	fi
+}
+
 check_results() {
 	echo "Check results"
 
@@ -60,5 +95,6 @@ tmp="$(tempfile)"
 build_uboot "${TRACE_OPT}"
 run_trace >${tmp}
 check_results ${tmp}
+check_depth_change
 rm ${tmp}
 echo "Test passed"
@@ -43,6 +43,8 @@ controlled by a description in the board device tree.'''
             help='Set argument value arg=value')
     build_parser.add_argument('-b', '--board', type=str,
             help='Board name to build')
+    build_parser.add_argument('-c', '--cache-dir', type=str,
+            help='Directory to use to cache compressed data between runs')
     build_parser.add_argument('-d', '--dt', type=str,
             help='Configuration file (.dtb) to use')
     build_parser.add_argument('--fake-dtb', action='store_true',
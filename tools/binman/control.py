@@ -519,11 +519,17 @@ def Binman(args):
             tools.PrepareOutputDir(args.outdir, args.preserve)
             tools.SetToolPaths(args.toolpath)
             state.SetEntryArgs(args.entry_arg)
+            state.SetCacheDir(args.cache_dir)
 
             images = PrepareImagesAndDtbs(dtb_fname, args.image,
                                           args.update_fdt)
             for image in images.values():
                 ProcessImage(image, args.update_fdt, args.map)
+            state.PruneCache()
+            reused, rebuilt = state.GetCacheStats()
+            if reused or rebuilt:
+                tout.Notice('Entry cache: %d reused, %d rebuilt' %
+                            (reused, rebuilt))
 
             # Write the updated FDTs to our output files
             for dtb_item in state.GetAllFdts():
@@ -6,6 +6,7 @@
 #
 
 from binman.entry import Entry
+from binman import state
 from dtoc import fdt_util
 from patman import tools
 from patman import tout
@@ -28,7 +29,8 @@ class Entry_blob(Entry):
 
     If compression is enabled, an extra 'uncomp-size' property is written to
     the node (if enabled with -u) which provides the uncompressed size of the
-    data.
+    data. The compressed data is cached, so it is only compressed again if the
+    file changes (see 'Entry cache' in the binman README).
     """
     def __init__(self, section, etype, node):
         Entry.__init__(self, section, etype, node)
@@ -42,10 +44,12 @@ class Entry_blob(Entry):
         return True
 
     def CompressData(self, indata):
-        if self.compress != 'none':
-            self.uncomp_size = len(indata)
-        data = tools.Compress(indata, self.compress)
-        return data
+        if self.compress == 'none':
+            return indata
+        self.uncomp_size = len(indata)
+        return state.GetCachedData(self.GetPath(),
+                lambda: tools.Compress(indata, self.compress),
+                'compress', self.compress, indata)
 
     def ReadBlobContents(self):
         """Read blob contents into memory
@@ -14,6 +14,7 @@ import shutil
 import struct
 import sys
 import tempfile
+import time
 import unittest
 
 from binman import cbfs_util
@@ -285,7 +286,7 @@ class TestFunctional(unittest.TestCase):
 
     def _DoTestFile(self, fname, debug=False, map=False, update_dtb=False,
                     entry_args=None, images=None, use_real_dtb=False,
-                    verbosity=None):
+                    verbosity=None, cache_dir=None):
         """Run binman with a given test file
 
         Args:
@@ -298,6 +299,7 @@ class TestFunctional(unittest.TestCase):
                 key: arg name
                 value: value of that arg
             images: List of image names to build
+            cache_dir: Directory to use to cache entry contents, or None
         """
         args = []
         if debug:
@@ -322,6 +324,8 @@ class TestFunctional(unittest.TestCase):
         if images:
             for image in images:
                 args += ['-i', image]
+        if cache_dir:
+            args += ['-c', cache_dir]
         return self._DoBinman(*args)
 
     def _SetupDtb(self, fname, outfile='u-boot.dtb'):
@@ -3357,6 +3361,65 @@ class TestFunctional(unittest.TestCase):
         data = self._DoReadFile('154_intel_fsp_t.dts')
         self.assertEqual(FSP_T_DATA, data[:len(FSP_T_DATA)])
 
+    def testEntryCache(self):
+        """Test that entry contents are reused between runs"""
+        self._CheckLz4()
+        expected = self._DoReadFile('083_compress.dts')
+        cache_dir = tempfile.mkdtemp(prefix='binman.cache.')
+        results = []
+        try:
+            for data in (COMPRESS_DATA, COMPRESS_DATA, COMPRESS_DATA + b'new'):
+                TestFunctional._MakeInputFile('compress', data)
+                with test_util.capture_sys_output() as (stdout, stderr):
+                    retcode = self._DoTestFile('083_compress.dts', verbosity=2,
+                                               cache_dir=cache_dir)
+                self.assertEqual(0, retcode)
+                results.append((tools.ReadFile(
+                    tools.GetOutputFilename('image.bin')), stdout.getvalue()))
+        finally:
+            TestFunctional._MakeInputFile('compress', COMPRESS_DATA)
+            shutil.rmtree(cache_dir)
+
+        # The second run reuses the contents; the image must not change
+        self.assertIn('Entry cache: 0 reused, 1 rebuilt', results[0][1])
+        self.assertIn('Entry cache: 1 reused, 0 rebuilt', results[1][1])
+        self.assertEqual(expected, results[0][0])
+        self.assertEqual(expected, results[1][0])
+
+        # Changing the input must cause the entry to be rebuilt
+        self.assertIn('Entry cache: 0 reused, 1 rebuilt', results[2][1])
+        self.assertEqual(COMPRESS_DATA + b'new',
+                         self._decompress(results[2][0]))
+
+    def testEntryCachePrune(self):
+        """Test that unused contents are pruned from the cache directory"""
+        self._CheckLz4()
+        cache_dir = tempfile.mkdtemp(prefix='binman.cache.')
+        stale = os.path.join(cache_dir, '0' * 64)
+        other = os.path.join(cache_dir, 'other')
+        old = time.time() - state.CACHE_MAX_AGE - 60
+        try:
+            for fname in (stale, other):
+                tools.WriteFile(fname, b'old')
+                os.utime(fname, (old, old))
+            self._DoTestFile('083_compress.dts', cache_dir=cache_dir)
+            self.assertFalse(os.path.exists(stale))
+            self.assertTrue(os.path.exists(other))
+            cached = [fname for fname in os.listdir(cache_dir)
+                      if fname != 'other']
+            self.assertEqual(1, len(cached))
+
+            # Reusing contents marks them as used, so they are not pruned
+            fname = os.path.join(cache_dir, cached[0])
+            os.utime(fname, (old, old))
+            with test_util.capture_sys_output() as (stdout, stderr):
+                self._DoTestFile('083_compress.dts', verbosity=2,
+                                 cache_dir=cache_dir)
+            self.assertIn('Entry cache: 1 reused, 0 rebuilt', stdout.getvalue())
+            self.assertTrue(os.path.exists(fname))
+        finally:
+            shutil.rmtree(cache_dir)
+
 
 if __name__ == "__main__":
     unittest.main()
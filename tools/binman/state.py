@@ -7,6 +7,7 @@
 
 import hashlib
 import re
+import time
 
 from dtoc import fdt
 import os
@@ -50,6 +51,30 @@ allow_entry_expansion = True
 # to the new ones, the compressed size increases, etc.
 allow_entry_contraction = False
 
+# Directory holding entry contents cached by earlier runs, or None to only
+# cache contents within this run. See GetCachedData()
+cache_dir = None
+
+# Entry contents cached so far:
+#   key: SHA256 hash of the inputs used to generate the contents
+#   value: contents (bytes)
+cached_data = {}
+
+# Number of times that entry contents were reused from the cache, or rebuilt
+cache_reused = 0
+cache_rebuilt = 0
+
+# Version of the cached contents, included in each key. Increase this when a
+# change to binman alters the contents generated from the same inputs, so that
+# contents cached by an older binman are not reused
+CACHE_VERSION = 1
+
+# Cached contents which have not been used for this long are pruned (seconds)
+CACHE_MAX_AGE = 30 * 24 * 60 * 60
+
+# Name of a file in the cache directory, i.e. a hex SHA256 key
+RE_CACHE_FILE = re.compile(r'^[0-9a-f]{64}(\.tmp)?$')
+
 def GetFdtForEtype(etype):
     """Get the Fdt object for a particular device-tree entry
 
@@ -389,3 +414,94 @@ def AllowEntryContraction():
             raised
     """
     return allow_entry_contraction
+
+def SetCacheDir(dirname):
+    """Set up the cache of entry contents
+
+    This empties the in-memory cache and resets the statistics. If a directory
+    is given, contents are also read from and written to it, so that later
+    runs of binman can reuse them.
+
+    Args:
+        dirname: Directory to hold the cache, or None for none
+    """
+    global cache_dir, cached_data, cache_reused, cache_rebuilt
+
+    cache_dir = dirname
+    cached_data = {}
+    cache_reused = 0
+    cache_rebuilt = 0
+    if dirname:
+        os.makedirs(dirname, exist_ok=True)
+
+def GetCachedData(path, func, *inputs):
+    """Get entry contents, reusing earlier contents if the inputs are the same
+
+    The contents are looked up using a hash of the inputs, which must include
+    everything that affects the result, e.g. the input data and any entry
+    properties used. If they are not found, func() is called to generate them
+    and they are added to the cache.
+
+    Args:
+        path: Path of the entry (used for reporting)
+        func: Function to call to generate the contents
+        inputs: Values which determine the contents (bytes, str or int)
+
+    Returns:
+        Entry contents, as bytes
+    """
+    global cache_reused, cache_rebuilt
+
+    m = hashlib.sha256(b'binman-cache-v%d:' % CACHE_VERSION)
+    for item in inputs:
+        if isinstance(item, int):
+            item = str(item)
+        if isinstance(item, str):
+            item = item.encode('utf-8')
+        m.update(b'%d:' % len(item))
+        m.update(item)
+    key = m.hexdigest()
+    fname = os.path.join(cache_dir, key) if cache_dir else None
+    data = cached_data.get(key)
+    if data is None and fname and os.path.exists(fname):
+        data = tools.ReadFile(fname)
+        # Mark the file as used, so that PruneCache() keeps it
+        os.utime(fname)
+    if data is not None:
+        tout.Info("Entry '%s': reusing cached contents" % path)
+        cache_reused += 1
+    else:
+        tout.Info("Entry '%s': rebuilding contents" % path)
+        data = func()
+        cache_rebuilt += 1
+        if fname:
+            # Write to a temporary file first, so a partial file is never used
+            tools.WriteFile(fname + '.tmp', data)
+            os.replace(fname + '.tmp', fname)
+    cached_data[key] = data
+    return data
+
+def PruneCache():
+    """Remove contents from the cache directory which have not been used lately
+
+    Files which were neither written nor reused in the last CACHE_MAX_AGE
+    seconds are removed. Other files in the directory are left alone.
+    """
+    if not cache_dir:
+        return
+    oldest = time.time() - CACHE_MAX_AGE
+    for name in os.listdir(cache_dir):
+        fname = os.path.join(cache_dir, name)
+        if RE_CACHE_FILE.match(name) and os.path.getmtime(fname) < oldest:
+            tout.Debug("Removing stale cache file '%s'" % name)
+            os.remove(fname)
+
+def GetCacheStats():
+    """Get statistics about the use of the entry-content cache
+
+    Returns:
+        Tuple:
+            Number of times cached contents were reused
+            Number of times contents were rebuilt
+    """
+    return cache_reused, cache_rebuilt
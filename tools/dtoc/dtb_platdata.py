@@ -13,6 +13,7 @@ static data.
 
 import collections
 import copy
+import struct
 import sys
 
 from dtoc import fdt
@@ -45,6 +46,25 @@ TYPE_NAMES = {
 STRUCT_PREFIX = 'dtd_'
 VAL_PREFIX = 'dtv_'
 
+# Properties which hold a list of phandles with arguments, along with the
+# property in the target node which gives the number of argument cells. Any
+# property called 'gpios' or ending in '-gpios' is also handled.
+PHANDLE_PROPS = {
+    'clocks': '#clock-cells',
+    'dmas': '#dma-cells',
+    'mboxes': '#mbox-cells',
+    'phys': '#phy-cells',
+    'power-domains': '#power-domain-cells',
+    'resets': '#reset-cells',
+}
+
+# Value used in the device-tree tables for a missing node
+DTT_NONE = 'DTT_NONE'
+
+# Maximum number of nodes in the device-tree tables. Node indexes are 16 bits
+# and DTT_NONE is 0xffff
+DTT_MAX_NODES = 0xffff
+
 # This holds information about a property which includes phandles.
 #
 # max_args: integer: Maximum number or arguments that any phandle uses (int).
@@ -108,6 +128,34 @@ def get_value(ftype, value):
     elif ftype == fdt.TYPE_INT64:
         return '%#x' % value
 
+def get_phandle_cells_name(prop_name):
+    """Get the name of the property giving the number of phandle arguments
+
+    Args:
+        prop_name: Name of property which might hold phandles
+
+    Returns:
+        Name of the '#...-cells' property to look for in each target node, or
+        None if the property does not hold phandles
+    """
+    if prop_name in PHANDLE_PROPS:
+        return PHANDLE_PROPS[prop_name]
+    if prop_name == 'gpios' or (prop_name.endswith('-gpios') and
+                                not prop_name.endswith('nr-gpios')):
+        return '#gpio-cells'
+    return None
+
+def c_string(value):
+    """Convert a string to a C string literal, including a nul terminator
+
+    Args:
+        value: String to convert
+
+    Returns:
+        C string literal, e.g. '"abc\\0"'
+    """
+    return '"%s\\0"' % value.replace('\\', '\\\\').replace('"', '\\"')
+
 def get_compat_name(node):
     """Get a node's first compatible string as a C identifier
 
@@ -548,6 +596,194 @@ class DtbPlatdata(object):
             self.output_node(node)
             nodes_to_output.remove(node)
 
+    def is_enabled(self, node):
+        """Check whether a node should be available for binding to a driver
+
+        Args:
+            node: Node to check
+
+        Returns:
+            True if the node is enabled, or disabled nodes are included
+        """
+        status = node.props.get('status')
+        return (self._include_disabled or not status or
+                status.value not in ('disabled', 'fail'))
+
+    def get_phandle_refs(self, prop, node_name):
+        """Resolve the phandles in a property to the nodes they refer to
+
+        Args:
+            prop: Prop object to check
+            node_name: Name of the node containing the property (for errors)
+
+        Returns:
+            List of tuples, one for each phandle in the property:
+                Index of the cell holding the phandle
+                Node object which the phandle refers to
+        """
+        cells_name = get_phandle_cells_name(prop.name)
+        if not cells_name:
+            return []
+        if len(prop.bytes) % 4:
+            raise ValueError("Property '%s' in node '%s' is not a list of cells"
+                             % (prop.name, node_name))
+        vals = struct.unpack('>%dI' % (len(prop.bytes) // 4), prop.bytes)
+        refs = []
+        i = 0
+        while i < len(vals):
+            phandle = vals[i]
+            # A zero phandle is an empty entry, e.g. a GPIO that is not present
+            if not phandle:
+                i += 1
+                continue
+            target = self._fdt.phandle_to_node.get(phandle)
+            if not target:
+                raise ValueError("Cannot parse '%s' in node '%s'" %
+                                 (prop.name, node_name))
+            cells = target.props.get(cells_name)
+            if not cells:
+                raise ValueError("Node '%s' has no '%s' property" %
+                                 (target.name, cells_name))
+            refs.append((i, target))
+            i += 1 + fdt_util.fdt32_to_cpu(cells.value)
+        return refs
+
+    def generate_dt_tables(self):
+        """Generate read-only tables holding the whole device tree
+
+        Unlike the 'platdata' output, this covers every node and property, not
+        just those with a compatible string. It writes out a string table, the
+        property values, tables of nodes and properties, and lookup tables for
+        phandles and compatible strings, both sorted for a binary search. It
+        also resolves the phandles in known properties (see PHANDLE_PROPS) to
+        node indexes, so that these need no lookup at runtime.
+
+        See the documentation in doc/driver-model/of-plat.rst and the
+        structures in include/dt-tables.h for more information.
+        """
+        nodes = []
+        def _add_node(node):
+            nodes.append(node)
+            for subnode in node.subnodes:
+                _add_node(subnode)
+        _add_node(self._fdt.GetRoot())
+        if len(nodes) > DTT_MAX_NODES:
+            raise ValueError('Too many nodes for device-tree tables (%d)' %
+                             len(nodes))
+        node_index = {node.path: i for i, node in enumerate(nodes)}
+
+        strings = collections.OrderedDict()
+        string_size = [0]
+        def _add_string(value):
+            if value not in strings:
+                strings[value] = string_size[0]
+                string_size[0] += len(value) + 1
+            return strings[value]
+        _add_string('')
+
+        def _index(node):
+            return str(node_index[node.path]) if node else DTT_NONE
+
+        values = bytearray()
+        prop_lines = []
+        node_lines = []
+        phandles = []
+        compats = []
+        refs = []
+        prop_count = 0
+        for node in nodes:
+            first_prop = prop_count
+            phandle = 0
+            if node.props:
+                prop_lines.append('\t/* %s */\n' % node.path)
+            for prop in node.props.values():
+                prop_lines.append('\t{%d, %d, %d},\n' %
+                                  (_add_string(prop.name), len(values),
+                                   len(prop.bytes)))
+                values += prop.bytes
+                values += bytes(-len(values) % 4)
+                if prop.name == 'phandle':
+                    phandle = fdt_util.fdt32_to_cpu(prop.value)
+                for cell, target in self.get_phandle_refs(prop, node.name):
+                    refs.append((prop_count, cell, node_index[target.path]))
+                prop_count += 1
+            if phandle:
+                phandles.append((phandle, node_index[node.path]))
+
+            compat = node.props.get('compatible')
+            if compat and self.is_enabled(node):
+                compat_list = compat.value
+                if not isinstance(compat_list, list):
+                    compat_list = [compat_list]
+                for value in compat_list:
+                    compats.append((value, node_index[node.path]))
+
+            parent = node.parent
+            sibling = None
+            if parent:
+                pos = parent.subnodes.index(node)
+                if pos + 1 < len(parent.subnodes):
+                    sibling = parent.subnodes[pos + 1]
+            first_child = node.subnodes[0] if node.subnodes else None
+            node_lines.append('\t{%d, %d, %d, %s, %s, %s, %d},\t/* %s */\n' %
+                              (_add_string(node.name if node.parent else ''),
+                               first_prop, phandle,
+                               _index(parent), _index(first_child),
+                               _index(sibling), len(node.props), node.path))
+        for value, _ in compats:
+            _add_string(value)
+
+        self.out_header()
+        self.out('#include <common.h>\n')
+        self.out('#include <dt-tables.h>\n')
+        self.out('\n')
+        self.out('static const char dtt_strings[] =\n')
+        self.out('\n'.join('\t%s' % c_string(value) for value in strings))
+        self.out(';\n\n')
+
+        self.out('static const u8 dtt_values[] __aligned(4) = {\n')
+        for i in range(0, len(values), 8):
+            self.out('\t%s,\n' % ', '.join('%#04x' % byte
+                                            for byte in values[i:i + 8]))
+        self.out('};\n\n')
+
+        self.out('static const struct dtt_prop dtt_props[] = {\n')
+        self.out(''.join(prop_lines))
+        self.out('};\n\n')
+
+        self.out('static const struct dtt_node dtt_nodes[] = {\n')
+        self.out(''.join(node_lines))
+        self.out('};\n\n')
+
+        self.out('static const struct dtt_phandle dtt_phandles[] = {\n')
+        for phandle, node in sorted(phandles):
+            self.out('\t{%d, %d},\n' % (phandle, node))
+        self.out('};\n\n')
+
+        self.out('static const struct dtt_compat dtt_compats[] = {\n')
+        for value, node in sorted(compats):
+            self.out('\t{%d, %d},\t/* %s */\n' % (strings[value], node, value))
+        self.out('};\n\n')
+
+        self.out('static const struct dtt_ref dtt_refs[] = {\n')
+        for prop, cell, node in refs:
+            self.out('\t{%d, %d, %d},\n' % (prop, cell, node))
+        self.out('};\n\n')
+
+        self.out('const struct dtt_tree dtt_tree = {\n')
+        self.out('\t.strings\t= dtt_strings,\n')
+        self.out('\t.values\t\t= dtt_values,\n')
+        self.out('\t.nodes\t\t= dtt_nodes,\n')
+        self.out('\t.props\t\t= dtt_props,\n')
+        self.out('\t.phandles\t= dtt_phandles,\n')
+        self.out('\t.compats\t= dtt_compats,\n')
+        self.out('\t.refs\t\t= dtt_refs,\n')
+        self.out('\t.num_nodes\t= ARRAY_SIZE(dtt_nodes),\n')
+        self.out('\t.num_phandles\t= ARRAY_SIZE(dtt_phandles),\n')
+        self.out('\t.num_compats\t= ARRAY_SIZE(dtt_compats),\n')
+        self.out('\t.num_refs\t= ARRAY_SIZE(dtt_refs),\n')
+        self.out('};\n')
+
 
 def run_steps(args, dtb_file, include_disabled, output):
     """Run all the steps of the dtoc tool
@@ -559,7 +795,8 @@ def run_steps(args, dtb_file, include_disabled, output):
         output: Name of output file
     """
     if not args:
-        raise ValueError('Please specify a command: struct, platdata')
+        raise ValueError('Please specify a command: struct, platdata, '
+                         'dt-tables')
 
     plat = DtbPlatdata(dtb_file, include_disabled)
     plat.scan_dtb()
@@ -574,6 +811,8 @@ def run_steps(args, dtb_file, include_disabled, output):
             plat.generate_structs(structs)
         elif cmd == 'platdata':
             plat.generate_tables()
+        elif cmd == 'dt-tables':
+            plat.generate_dt_tables()
         else:
-            raise ValueError("Unknown command '%s': (use: struct, platdata)" %
-                             cmd)
+            raise ValueError("Unknown command '%s': (use: struct, platdata, "
+                             "dt-tables)" % cmd)
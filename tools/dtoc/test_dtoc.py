@@ -13,10 +13,12 @@ import collections
 import os
 import struct
 import unittest
+from unittest import mock
 
 from dtoc import dtb_platdata
 from dtb_platdata import conv_name_to_c
 from dtb_platdata import get_compat_name
+from dtb_platdata import get_phandle_cells_name
 from dtb_platdata import get_value
 from dtb_platdata import tab_to
 from dtoc import fdt
@@ -47,6 +49,16 @@ C_HEADER = '''/*
 #include <dt-structs.h>
 '''
 
+DTT_HEADER = '''/*
+ * DO NOT MODIFY
+ *
+ * This file was generated by dtoc from a .dtb (device tree binary) file.
+ */
+
+#include <common.h>
+#include <dt-tables.h>
+'''
+
 
 
 def get_dtb_file(dts_fname, capture_stderr=False):
@@ -698,7 +710,7 @@ U_BOOT_DEVICE(spl_test2) = {
         """Test running dtoc without a command"""
         with self.assertRaises(ValueError) as e:
             dtb_platdata.run_steps([], '', False, '')
-        self.assertIn("Please specify a command: struct, platdata",
+        self.assertIn("Please specify a command: struct, platdata, dt-tables",
                       str(e.exception))
 
     def testBadCommand(self):
@@ -707,5 +719,331 @@ U_BOOT_DEVICE(spl_test2) = {
         output = tools.GetOutputFilename('output')
         with self.assertRaises(ValueError) as e:
             dtb_platdata.run_steps(['invalid-cmd'], dtb_file, False, output)
-        self.assertIn("Unknown command 'invalid-cmd': (use: struct, platdata)",
+        self.assertIn(
+            "Unknown command 'invalid-cmd': (use: struct, platdata, dt-tables)",
+            str(e.exception))
+
+    def test_dt_tables_empty(self):
+        """Test device-tree tables for a device tree file with no nodes"""
+        dtb_file = get_dtb_file('dtoc_test_empty.dts')
+        output = tools.GetOutputFilename('output')
+        dtb_platdata.run_steps(['dt-tables'], dtb_file, False, output)
+        with open(output) as infile:
+            data = infile.read()
+        self._CheckStrings(DTT_HEADER + '''
+static const char dtt_strings[] =
+\t"\\0";
+
+static const u8 dtt_values[] __aligned(4) = {
+};
+
+static const struct dtt_prop dtt_props[] = {
+};
+
+static const struct dtt_node dtt_nodes[] = {
+\t{0, 0, 0, DTT_NONE, DTT_NONE, DTT_NONE, 0},\t/* / */
+};
+
+static const struct dtt_phandle dtt_phandles[] = {
+};
+
+static const struct dtt_compat dtt_compats[] = {
+};
+
+static const struct dtt_ref dtt_refs[] = {
+};
+
+const struct dtt_tree dtt_tree = {
+\t.strings\t= dtt_strings,
+\t.values\t\t= dtt_values,
+\t.nodes\t\t= dtt_nodes,
+\t.props\t\t= dtt_props,
+\t.phandles\t= dtt_phandles,
+\t.compats\t= dtt_compats,
+\t.refs\t\t= dtt_refs,
+\t.num_nodes\t= ARRAY_SIZE(dtt_nodes),
+\t.num_phandles\t= ARRAY_SIZE(dtt_phandles),
+\t.num_compats\t= ARRAY_SIZE(dtt_compats),
+\t.num_refs\t= ARRAY_SIZE(dtt_refs),
+};
+''', data)
+
+    def test_dt_tables(self):
+        """Test device-tree tables with phandles in a 'clocks' property"""
+        dtb_file = get_dtb_file('dtoc_test_phandle.dts')
+        output = tools.GetOutputFilename('output')
+        dtb_platdata.run_steps(['dt-tables'], dtb_file, False, output)
+        with open(output) as infile:
+            data = infile.read()
+        self._CheckStrings(DTT_HEADER + '''
+static const char dtt_strings[] =
+\t"\\0"
+\t"u-boot,dm-pre-reloc\\0"
+\t"compatible\\0"
+\t"intval\\0"
+\t"#clock-cells\\0"
+\t"phandle\\0"
+\t"phandle-target\\0"
+\t"phandle2-target\\0"
+\t"phandle3-target\\0"
+\t"clocks\\0"
+\t"phandle-source\\0"
+\t"phandle-source2\\0"
+\t"target\\0"
+\t"source\\0";
+
+static const u8 dtt_values[] __aligned(4) = {
+\t0x74, 0x61, 0x72, 0x67, 0x65, 0x74, 0x00, 0x00,
+\t0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+\t0x00, 0x00, 0x00, 0x01, 0x74, 0x61, 0x72, 0x67,
+\t0x65, 0x74, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01,
+\t0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x02,
+\t0x74, 0x61, 0x72, 0x67, 0x65, 0x74, 0x00, 0x00,
+\t0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x02,
+\t0x00, 0x00, 0x00, 0x03, 0x73, 0x6f, 0x75, 0x72,
+\t0x63, 0x65, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01,
+\t0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x0b,
+\t0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x0c,
+\t0x00, 0x00, 0x00, 0x0d, 0x00, 0x00, 0x00, 0x01,
+\t0x73, 0x6f, 0x75, 0x72, 0x63, 0x65, 0x00, 0x00,
+\t0x00, 0x00, 0x00, 0x01,
+};
+
+static const struct dtt_prop dtt_props[] = {
+\t/* /phandle-target */
+\t{1, 0, 0},
+\t{21, 0, 7},
+\t{32, 8, 4},
+\t{39, 12, 4},
+\t{52, 16, 4},
+\t/* /phandle2-target */
+\t{1, 20, 0},
+\t{21, 20, 7},
+\t{32, 28, 4},
+\t{39, 32, 4},
+\t{52, 36, 4},
+\t/* /phandle3-target */
+\t{1, 40, 0},
+\t{21, 40, 7},
+\t{32, 48, 4},
+\t{39, 52, 4},
+\t{52, 56, 4},
+\t/* /phandle-source */
+\t{1, 60, 0},
+\t{21, 60, 7},
+\t{107, 68, 28},
+\t/* /phandle-source2 */
+\t{1, 96, 0},
+\t{21, 96, 7},
+\t{107, 104, 4},
+};
+
+static const struct dtt_node dtt_nodes[] = {
+\t{0, 0, 0, DTT_NONE, 1, DTT_NONE, 0},\t/* / */
+\t{60, 0, 1, 0, DTT_NONE, 2, 5},\t/* /phandle-target */
+\t{75, 5, 2, 0, DTT_NONE, 3, 5},\t/* /phandle2-target */
+\t{91, 10, 3, 0, DTT_NONE, 4, 5},\t/* /phandle3-target */
+\t{114, 15, 0, 0, DTT_NONE, 5, 3},\t/* /phandle-source */
+\t{129, 18, 0, 0, DTT_NONE, DTT_NONE, 3},\t/* /phandle-source2 */
+};
+
+static const struct dtt_phandle dtt_phandles[] = {
+\t{1, 1},
+\t{2, 2},
+\t{3, 3},
+};
+
+static const struct dtt_compat dtt_compats[] = {
+\t{152, 4},\t/* source */
+\t{152, 5},\t/* source */
+\t{145, 1},\t/* target */
+\t{145, 2},\t/* target */
+\t{145, 3},\t/* target */
+};
+
+static const struct dtt_ref dtt_refs[] = {
+\t{17, 0, 1},
+\t{17, 1, 2},
+\t{17, 3, 3},
+\t{17, 6, 1},
+\t{20, 0, 1},
+};
+
+const struct dtt_tree dtt_tree = {
+\t.strings\t= dtt_strings,
+\t.values\t\t= dtt_values,
+\t.nodes\t\t= dtt_nodes,
+\t.props\t\t= dtt_props,
+\t.phandles\t= dtt_phandles,
+\t.compats\t= dtt_compats,
+\t.refs\t\t= dtt_refs,
+\t.num_nodes\t= ARRAY_SIZE(dtt_nodes),
+\t.num_phandles\t= ARRAY_SIZE(dtt_phandles),
+\t.num_compats\t= ARRAY_SIZE(dtt_compats),
+\t.num_refs\t= ARRAY_SIZE(dtt_refs),
+};
+''', data)
+
+    def test_dt_tables_gpios(self):
+        """Test device-tree tables with subnodes, GPIOs and a disabled node"""
+        dtb_file = get_dtb_file('dtoc_test_dt_tables.dts')
+        output = tools.GetOutputFilename('output')
+        dtb_platdata.run_steps(['dt-tables'], dtb_file, False, output)
+        with open(output) as infile:
+            data = infile.read()
+        self._CheckStrings(DTT_HEADER + '''
+static const char dtt_strings[] =
+\t"\\0"
+\t"compatible\\0"
+\t"gpio-controller\\0"
+\t"#gpio-cells\\0"
+\t"phandle\\0"
+\t"#address-cells\\0"
+\t"#size-cells\\0"
+\t"i2c@0\\0"
+\t"reg\\0"
+\t"status\\0"
+\t"eeprom@50\\0"
+\t"enable-gpios\\0"
+\t"nr-gpios\\0"
+\t"leds\\0"
+\t"sandbox,gpio\\0"
+\t"sandbox,i2c\\0"
+\t"simple-bus\\0"
+\t"gpio-leds\\0";
+
+static const u8 dtt_values[] __aligned(4) = {
+\t0x73, 0x61, 0x6e, 0x64, 0x62, 0x6f, 0x78, 0x2c,
+\t0x67, 0x70, 0x69, 0x6f, 0x00, 0x00, 0x00, 0x00,
+\t0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x01,
+\t0x73, 0x61, 0x6e, 0x64, 0x62, 0x6f, 0x78, 0x2c,
+\t0x69, 0x32, 0x63, 0x00, 0x73, 0x69, 0x6d, 0x70,
+\t0x6c, 0x65, 0x2d, 0x62, 0x75, 0x73, 0x00, 0x00,
+\t0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00,
+\t0x69, 0x32, 0x63, 0x2d, 0x65, 0x65, 0x70, 0x72,
+\t0x6f, 0x6d, 0x00, 0x00, 0x00, 0x00, 0x00, 0x50,
+\t0x64, 0x69, 0x73, 0x61, 0x62, 0x6c, 0x65, 0x64,
+\t0x00, 0x00, 0x00, 0x00, 0x67, 0x70, 0x69, 0x6f,
+\t0x2d, 0x6c, 0x65, 0x64, 0x73, 0x00, 0x00, 0x00,
+\t0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01,
+\t0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+\t0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x03,
+\t0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x02,
+};
+
+static const struct dtt_prop dtt_props[] = {
+\t/* /gpio-controller */
+\t{1, 0, 13},
+\t{12, 16, 0},
+\t{28, 16, 4},
+\t{40, 20, 4},
+\t/* /i2c@0 */
+\t{1, 24, 23},
+\t{48, 48, 4},
+\t{63, 52, 4},
+\t/* /i2c@0/eeprom@50 */
+\t{1, 56, 11},
+\t{81, 68, 4},
+\t{85, 72, 9},
+\t/* /leds */
+\t{1, 84, 10},
+\t{102, 96, 28},
+\t{115, 124, 4},
+};
+
+static const struct dtt_node dtt_nodes[] = {
+\t{0, 0, 0, DTT_NONE, 1, DTT_NONE, 0},\t/* / */
+\t{12, 0, 1, 0, DTT_NONE, 2, 4},\t/* /gpio-controller */
+\t{75, 4, 0, 0, 3, 4, 3},\t/* /i2c@0 */
+\t{92, 7, 0, 2, DTT_NONE, DTT_NONE, 3},\t/* /i2c@0/eeprom@50 */
+\t{124, 10, 0, 0, DTT_NONE, DTT_NONE, 3},\t/* /leds */
+};
+
+static const struct dtt_phandle dtt_phandles[] = {
+\t{1, 1},
+};
+
+static const struct dtt_compat dtt_compats[] = {
+\t{165, 4},\t/* gpio-leds */
+\t{129, 1},\t/* sandbox,gpio */
+\t{142, 2},\t/* sandbox,i2c */
+\t{154, 2},\t/* simple-bus */
+};
+
+static const struct dtt_ref dtt_refs[] = {
+\t{11, 0, 1},
+\t{11, 4, 1},
+};
+
+const struct dtt_tree dtt_tree = {
+\t.strings\t= dtt_strings,
+\t.values\t\t= dtt_values,
+\t.nodes\t\t= dtt_nodes,
+\t.props\t\t= dtt_props,
+\t.phandles\t= dtt_phandles,
+\t.compats\t= dtt_compats,
+\t.refs\t\t= dtt_refs,
+\t.num_nodes\t= ARRAY_SIZE(dtt_nodes),
+\t.num_phandles\t= ARRAY_SIZE(dtt_phandles),
+\t.num_compats\t= ARRAY_SIZE(dtt_compats),
+\t.num_refs\t= ARRAY_SIZE(dtt_refs),
+};
+''', data)
+
+        # The disabled node should appear in the compatible-string table now
+        dtb_platdata.run_steps(['dt-tables'], dtb_file, True, output)
+        with open(output) as infile:
+            data = infile.read()
+        self.assertIn('''static const struct dtt_compat dtt_compats[] = {
+\t{176, 4},\t/* gpio-leds */
+\t{165, 3},\t/* i2c-eeprom */
+''', data)
+
+    def test_dt_tables_phandle_bad(self):
+        """Test device-tree tables with an invalid phandle"""
+        dtb_file = get_dtb_file('dtoc_test_dt_tables_bad.dts',
+                                capture_stderr=True)
+        output = tools.GetOutputFilename('output')
+        with self.assertRaises(ValueError) as e:
+            dtb_platdata.run_steps(['dt-tables'], dtb_file, False, output)
+        self.assertIn("Cannot parse 'resets' in node 'reset-source'",
+                      str(e.exception))
+
+    def test_dt_tables_phandle_bad2(self):
+        """Test device-tree tables with a target missing its #*-cells"""
+        dtb_file = get_dtb_file('dtoc_test_dt_tables_bad2.dts',
+                                capture_stderr=True)
+        output = tools.GetOutputFilename('output')
+        with self.assertRaises(ValueError) as e:
+            dtb_platdata.run_steps(['dt-tables'], dtb_file, False, output)
+        self.assertIn("Node 'reset-controller' has no '#reset-cells' property",
                       str(e.exception))
+
+    def test_dt_tables_bad_cells(self):
+        """Test device-tree tables with a phandle list of the wrong size"""
+        dtb_file = get_dtb_file('dtoc_test_dt_tables_bad3.dts',
+                                capture_stderr=True)
+        output = tools.GetOutputFilename('output')
+        with self.assertRaises(ValueError) as e:
+            dtb_platdata.run_steps(['dt-tables'], dtb_file, False, output)
+        self.assertIn(
+            "Property 'resets' in node 'reset-source' is not a list of cells",
+            str(e.exception))
+
+    def test_dt_tables_too_many_nodes(self):
+        """Test device-tree tables with more nodes than can be indexed"""
+        dtb_file = get_dtb_file('dtoc_test_phandle.dts')
+        output = tools.GetOutputFilename('output')
+        with mock.patch.object(dtb_platdata, 'DTT_MAX_NODES', 5):
+            with self.assertRaises(ValueError) as e:
+                dtb_platdata.run_steps(['dt-tables'], dtb_file, False, output)
+        self.assertIn('Too many nodes for device-tree tables (6)',
+                      str(e.exception))
+
+    def test_phandle_cells_name(self):
+        """Test finding the #*-cells property for a phandle property"""
+        self.assertEqual('#clock-cells', get_phandle_cells_name('clocks'))
+        self.assertEqual('#gpio-cells', get_phandle_cells_name('gpios'))
+        self.assertEqual('#gpio-cells', get_phandle_cells_name('cd-gpios'))
+        self.assertIsNone(get_phandle_cells_name('nr-gpios'))
+        self.assertIsNone(get_phandle_cells_name('reg'))
@@ -642,9 +642,10 @@ err:
 static int copyfile(const char *src, const char *dst)
 {
 	int fd_src = -1, fd_dst = -1;
-	void *buf = NULL;
+	void *buf = MAP_FAILED;
+	struct stat sbuf;
+	off_t done;
 	ssize_t size;
-	size_t count;
 	int ret = -1;
 
 	fd_src = open(src, O_RDONLY);
@@ -653,29 +654,32 @@ static int copyfile(const char *src, const char *dst)
 		goto out;
 	}
 
-	fd_dst = open(dst, O_WRONLY | O_CREAT, 0666);
-	if (fd_dst < 0) {
-		printf("Can't open file %s (%s)\n", dst, strerror(errno));
+	if (fstat(fd_src, &sbuf) < 0) {
+		printf("Can't stat file %s (%s)\n", src, strerror(errno));
 		goto out;
 	}
 
-	buf = malloc(512);
-	if (!buf) {
-		printf("Can't allocate buffer to copy file\n");
+	fd_dst = open(dst, O_WRONLY | O_CREAT, 0666);
+	if (fd_dst < 0) {
+		printf("Can't open file %s (%s)\n", dst, strerror(errno));
 		goto out;
 	}
 
-	while (1) {
-		size = read(fd_src, buf, 512);
-		if (size < 0) {
+	/*
+	 * This is called for every attempt at signing, so map the file and
+	 * write it in one go rather than copying it through a small buffer
+	 */
+	if (sbuf.st_size) {
+		buf = mmap(NULL, sbuf.st_size, PROT_READ, MAP_SHARED, fd_src,
+			   0);
+		if (buf == MAP_FAILED) {
 			printf("Can't read file %s\n", src);
 			goto out;
 		}
-		if (!size)
-			break;
+	}
 
-		count = size;
-		size = write(fd_dst, buf, count);
+	for (done = 0; done < sbuf.st_size; done += size) {
+		size = write(fd_dst, buf + done, sbuf.st_size - done);
 		if (size < 0) {
 			printf("Can't write file %s\n", dst);
 			goto out;
@@ -685,12 +689,12 @@ static int copyfile(const char *src, const char *dst)
 	ret = 0;
 
  out:
+	if (buf != MAP_FAILED)
+		munmap(buf, sbuf.st_size);
 	if (fd_src >= 0)
 		close(fd_src);
 	if (fd_dst >= 0)
 		close(fd_dst);
-	if (buf)
-		free(buf);
 
 	return ret;
 }
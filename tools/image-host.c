@@ -12,8 +12,12 @@
 #include <bootm.h>
 #include <fdt_region.h>
 #include <image.h>
+#include <pthread.h>
 #include <version.h>
 
+/* Maximum number of threads used to calculate image hashes */
+#define HASH_MAX_THREADS	16
+
 /**
  * fit_set_hash_value - set hash value in requested has node
  * @fit: pointer to the FIT format image header
@@ -44,6 +48,226 @@ static int fit_set_hash_value(void *fit, int noffset, uint8_t *value,
 	return 0;
 }
 
+/**
+ * struct hash_entry - a hash value calculated for an image
+ *
+ * mkimage may add verification data to the same FIT several times, since it
+ * starts again with a larger blob if the signatures do not fit. Each attempt
+ * starts from the same image data, so every hash value is calculated once, in
+ * parallel, and then reused. This also covers images with several hash nodes
+ * using the same algorithm.
+ *
+ * @image_name:	name of the image node
+ * @algo:	hash algorithm, e.g. "sha256"
+ * @size:	size of the hashed data in bytes
+ * @data:	data to hash; only valid until the hash has been calculated
+ * @value:	hash value
+ * @value_len:	length of the hash value in bytes, 0 if it could not be
+ *		calculated
+ */
+struct hash_entry {
+	char *image_name;
+	char *algo;
+	size_t size;
+	const void *data;
+	uint8_t value[FIT_MAX_HASH_LEN];
+	int value_len;
+};
+
+/**
+ * struct hash_pool - work shared by the hashing threads
+ *
+ * @entry:	hash entries to calculate
+ * @count:	number of entries
+ * @next:	next entry to hand out to a thread
+ * @lock:	protects @next
+ */
+struct hash_pool {
+	struct hash_entry *entry;
+	int count;
+	int next;
+	pthread_mutex_t lock;
+};
+
+/* Hash values calculated so far, kept for the lifetime of the tool */
+static struct hash_entry *hash_cache;
+static int hash_cache_count;
+
+static struct hash_entry *hash_cache_find(const char *image_name,
+					  const char *algo, size_t size)
+{
+	int i;
+
+	for (i = 0; i < hash_cache_count; i++) {
+		struct hash_entry *entry = &hash_cache[i];
+
+		if (entry->size == size && !strcmp(entry->algo, algo) &&
+		    !strcmp(entry->image_name, image_name))
+			return entry;
+	}
+
+	return NULL;
+}
+
+static struct hash_entry *hash_cache_add(const char *image_name,
+					 const char *algo, const void *data,
+					 size_t size)
+{
+	struct hash_entry *cache, *entry;
+
+	cache = realloc(hash_cache, (hash_cache_count + 1) * sizeof(*cache));
+	if (!cache)
+		return NULL;
+	hash_cache = cache;
+	entry = &hash_cache[hash_cache_count];
+	memset(entry, '\0', sizeof(*entry));
+	entry->image_name = strdup(image_name);
+	entry->algo = strdup(algo);
+	if (!entry->image_name || !entry->algo) {
+		free(entry->image_name);
+		free(entry->algo);
+		return NULL;
+	}
+	entry->data = data;
+	entry->size = size;
+	hash_cache_count++;
+
+	return entry;
+}
+
+static int hash_entry_cmp_size(const void *a, const void *b)
+{
+	const struct hash_entry *ea = a, *eb = b;
+
+	/* Largest first, so that one big image does not end up last */
+	if (ea->size != eb->size)
+		return ea->size < eb->size ? 1 : -1;
+
+	return 0;
+}
+
+static void *hash_worker(void *arg)
+{
+	struct hash_pool *pool = arg;
+
+	while (1) {
+		struct hash_entry *entry = NULL;
+
+		pthread_mutex_lock(&pool->lock);
+		if (pool->next < pool->count)
+			entry = &pool->entry[pool->next++];
+		pthread_mutex_unlock(&pool->lock);
+		if (!entry)
+			break;
+
+		if (calculate_hash(entry->data, entry->size, entry->algo,
+				   entry->value, &entry->value_len))
+			entry->value_len = 0;
+		entry->data = NULL;
+	}
+
+	return NULL;
+}
+
+/**
+ * hash_run_pool() - Calculate a list of hash values using several threads
+ *
+ * Nothing is written to the FIT while this runs, so the data pointers stay
+ * valid. If threads cannot be created, the remaining work is done by the
+ * calling thread.
+ *
+ * @entry:	entries to calculate
+ * @count:	number of entries
+ */
+static void hash_run_pool(struct hash_entry *entry, int count)
+{
+	pthread_t thread[HASH_MAX_THREADS];
+	struct hash_pool pool;
+	int nthreads, i;
+	long cpus;
+
+	pool.entry = entry;
+	pool.count = count;
+	pool.next = 0;
+	pthread_mutex_init(&pool.lock, NULL);
+
+	/* The calling thread does some of the work too */
+	cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	nthreads = count - 1;
+	if (cpus > 0 && nthreads > cpus - 1)
+		nthreads = cpus - 1;
+	if (nthreads > HASH_MAX_THREADS)
+		nthreads = HASH_MAX_THREADS;
+	for (i = 0; i < nthreads; i++) {
+		if (pthread_create(&thread[i], NULL, hash_worker, &pool))
+			break;
+	}
+	nthreads = i;
+	hash_worker(&pool);
+	for (i = 0; i < nthreads; i++)
+		pthread_join(thread[i], NULL);
+	pthread_mutex_destroy(&pool.lock);
+}
+
+/**
+ * fit_image_calc_hashes() - Calculate the hash values for all images
+ *
+ * This finds each hash node in the images/ node and calculates any hash
+ * values which are not already known. The values are written to the FIT
+ * later, in node order, by fit_image_process_hash().
+ *
+ * Errors such as a missing algorithm are ignored here, since they are
+ * reported when the node is processed.
+ *
+ * @fit:	pointer to the FIT format image header
+ * @images_noffset: offset of the images/ node
+ * @return 0 if ok, -ENOMEM if out of memory
+ */
+static int fit_image_calc_hashes(void *fit, int images_noffset)
+{
+	int image_noffset, noffset;
+	int first = hash_cache_count;
+
+	for (image_noffset = fdt_first_subnode(fit, images_noffset);
+	     image_noffset >= 0;
+	     image_noffset = fdt_next_subnode(fit, image_noffset)) {
+		const char *image_name;
+		const void *data;
+		size_t size;
+
+		if (fit_image_get_data(fit, image_noffset, &data, &size))
+			continue;
+		image_name = fit_get_name(fit, image_noffset, NULL);
+
+		for (noffset = fdt_first_subnode(fit, image_noffset);
+		     noffset >= 0;
+		     noffset = fdt_next_subnode(fit, noffset)) {
+			const char *node_name;
+			char *algo;
+
+			node_name = fit_get_name(fit, noffset, NULL);
+			if (strncmp(node_name, FIT_HASH_NODENAME,
+				    strlen(FIT_HASH_NODENAME)) ||
+			    fit_image_hash_get_algo(fit, noffset, &algo) ||
+			    hash_cache_find(image_name, algo, size))
+				continue;
+			if (!hash_cache_add(image_name, algo, data, size)) {
+				printf("Out of memory hashing image '%s'\n",
+				       image_name);
+				return -ENOMEM;
+			}
+		}
+	}
+
+	if (hash_cache_count > first) {
+		qsort(hash_cache + first, hash_cache_count - first,
+		      sizeof(*hash_cache), hash_entry_cmp_size);
+		hash_run_pool(hash_cache + first, hash_cache_count - first);
+	}
+
+	return 0;
+}
+
 /**
  * fit_image_process_hash - Process a single subnode of the images/ node
  *
@@ -60,8 +284,10 @@ static int fit_set_hash_value(void *fit, int noffset, uint8_t *value,
 static int fit_image_process_hash(void *fit, const char *image_name,
 		int noffset, const void *data, size_t size)
 {
-	uint8_t value[FIT_MAX_HASH_LEN];
+	uint8_t buf[FIT_MAX_HASH_LEN];
+	struct hash_entry *entry;
 	const char *node_name;
+	uint8_t *value = buf;
 	int value_len;
 	char *algo;
 	int ret;
@@ -74,7 +300,12 @@ static int fit_image_process_hash(void *fit, const char *image_name,
 		return -ENOENT;
 	}
 
-	if (calculate_hash(data, size, algo, value, &value_len)) {
+	/* Use the value from fit_image_calc_hashes(), if there is one */
+	entry = hash_cache_find(image_name, algo, size);
+	if (entry && entry->value_len) {
+		value = entry->value;
+		value_len = entry->value_len;
+	} else if (calculate_hash(data, size, algo, value, &value_len)) {
 		printf("Unsupported hash algorithm (%s) for '%s' hash node in '%s' image node\n",
 		       algo, node_name, image_name);
 		return -EPROTONOSUPPORT;
@@ -983,6 +1214,11 @@ int fit_add_verification_data(const char *keydir, void *keydest, void *fit,
 		return images_noffset;
 	}
 
+	/* Calculate all the image hashes up front, in parallel */
+	ret = fit_image_calc_hashes(fit, images_noffset);
+	if (ret)
+		return ret;
+
 	/* Process its subnodes, print out component images details */
 	for (noffset = fdt_first_subnode(fit, images_noffset);
 	     noffset >= 0;
@@ -10,6 +10,8 @@
 #include <limits.h>
 #include <regex.h>
 #include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -51,10 +53,35 @@ struct trace_configline_info {
 /* The contents of the trace config file */
 struct trace_configline_info *trace_config_head;
 
+/* Caller offset used when the caller is not known */
+#define CALLER_UNKNOWN	UINT32_MAX
+
+/* A function entry or exit, decoded from the trace data */
+struct call_info {
+	uint32_t func;		/* Function offset */
+	uint32_t caller;	/* Caller offset, or CALLER_UNKNOWN */
+	bool exit;		/* true for a function exit, false for entry */
+	uint64_t time;		/* Timestamp in microseconds */
+};
+
+/* A function which has been entered, used to track the call stack */
+struct stack_frame {
+	const char *name;	/* Function name, or NULL if not traced */
+	uint64_t start;		/* Time of function entry */
+	uint64_t child_time;	/* Time spent in called functions */
+};
+
+/* A call stack and the time spent in it, for a flame graph */
+struct stack_time {
+	char *stack;		/* Function names, separated by ';' */
+	uint64_t time;		/* Time in microseconds */
+};
+
 struct func_info *func_list;
 int func_count;
-struct trace_call *call_list;
+struct call_info *call_list;
 int call_count;
+int call_alloced;
 int verbose;	/* Verbosity level 0=none, 1=warn, 2=notice, 3=info, 4=debug */
 unsigned long text_offset;		/* text address of first function */
 
@@ -85,6 +112,8 @@ static void usage(void)
 		"\n"
 		"Commands\n"
 		"   dump-ftrace\t\tDump out textual data in ftrace format\n"
+		"   dump-chrome\t\tDump out trace events in Chrome JSON format\n"
+		"   dump-flamegraph\tDump out folded call stacks for flame graphs\n"
 		"\n"
 		"Options:\n"
 		"   -m <map>\tSpecify Systen.map file\n"
@@ -205,25 +234,145 @@ static struct func_info *find_caller_by_offset(uint32_t offset)
 	return low >= 0 ? &func_list[low] : NULL;
 }
 
+static struct call_info *add_call(void)
+{
+	if (call_count == call_alloced) {
+		call_alloced = call_alloced ? call_alloced * 2 : 4096;
+		call_list = realloc(call_list,
+				    sizeof(struct call_info) * call_alloced);
+		if (!call_list) {
+			error("Cannot allocate call_list\n");
+			return NULL;
+		}
+	}
+
+	return &call_list[call_count++];
+}
+
+/* Read the fixed-size call records written by older versions of U-Boot */
 static int read_calls(FILE *fin, size_t count)
 {
-	struct trace_call *call_data;
+	struct trace_call call_data;
+	struct call_info *call;
 	int i;
 
 	notice("call count: %zu\n", count);
-	call_list = (struct trace_call *)calloc(count, sizeof(*call_data));
-	if (!call_list) {
-		error("Cannot allocate call_list\n");
+	for (i = 0; i < count; i++) {
+		if (read_data(fin, &call_data, sizeof(call_data)))
+			return 1;
+		if (TRACE_CALL_TYPE(&call_data) != FUNCF_ENTRY &&
+		    TRACE_CALL_TYPE(&call_data) != FUNCF_EXIT)
+			continue;
+
+		call = add_call();
+		if (!call)
+			return -1;
+		call->func = call_data.func;
+		call->caller = call_data.caller;
+		call->exit = TRACE_CALL_TYPE(&call_data) == FUNCF_EXIT;
+		call->time = call_data.flags & FUNCF_TIMESTAMP_MASK;
+	}
+	return 0;
+}
+
+static int get_uleb128(const unsigned char **ptrp, const unsigned char *end,
+		       uint64_t *valp)
+{
+	const unsigned char *ptr = *ptrp;
+	uint64_t val = 0;
+	int shift;
+
+	for (shift = 0; ptr < end && shift < 64; shift += 7) {
+		val |= (uint64_t)(*ptr & 0x7f) << shift;
+		if (!(*ptr++ & 0x80)) {
+			*ptrp = ptr;
+			*valp = val;
+			return 0;
+		}
+	}
+
+	return -1;
+}
+
+/*
+ * Decode the compact call trace described by struct trace_ring_hdr. Exits
+ * belong to the innermost open entry. Exits for functions entered before
+ * the first record are skipped, since there is nothing to match them with.
+ */
+static int read_ring(FILE *fin, size_t size)
+{
+	struct trace_ring_hdr ring_hdr;
+	const unsigned char *ptr, *end;
+	unsigned char *buff;
+	uint32_t *stack = NULL;
+	int depth = 0, stack_size = 0;
+	int unmatched = 0;
+	uint64_t time, val;
+	int ret = 0;
+
+	if (read_data(fin, &ring_hdr, sizeof(ring_hdr)))
+		return 1;
+	notice("call trace: %zu bytes, %llu older records dropped\n", size,
+	       (unsigned long long)ring_hdr.dropped);
+	buff = malloc(size);
+	if (!buff) {
+		error("Cannot allocate call trace\n");
 		return -1;
 	}
-	call_count = count;
+	if (size && read_data(fin, buff, size)) {
+		free(buff);
+		return 1;
+	}
 
-	call_data = call_list;
-	for (i = 0; i < count; i++, call_data++) {
-		if (read_data(fin, call_data, sizeof(*call_data)))
-			return 1;
+	time = ring_hdr.base_time;
+	for (ptr = buff, end = buff + size; ptr < end;) {
+		struct call_info *call;
+
+		if (get_uleb128(&ptr, end, &val))
+			break;
+		time += val >> 1;
+		if ((val & 1) && !depth) {
+			unmatched++;
+			continue;
+		}
+
+		call = add_call();
+		if (!call) {
+			ret = -1;
+			break;
+		}
+		call->time = time;
+		call->exit = val & 1;
+		if (call->exit) {
+			call->func = stack[--depth];
+		} else {
+			if (get_uleb128(&ptr, end, &val)) {
+				call_count--;
+				break;
+			}
+			call->func = val * FUNC_SITE_SIZE;
+			if (depth == stack_size) {
+				stack_size = stack_size ? stack_size * 2 : 64;
+				stack = realloc(stack,
+						sizeof(*stack) * stack_size);
+				assert(stack);
+			}
+			stack[depth++] = call->func;
+		}
+		call->caller = depth > !call->exit ?
+			stack[depth - 1 - !call->exit] : CALLER_UNKNOWN;
 	}
-	return 0;
+	if (ptr != end) {
+		error("Call trace is corrupt at byte %ld\n",
+		      (long)(ptr - buff));
+		ret = ret ? ret : 1;
+	}
+	info("call trace: %d exits without an entry, %d entries without an exit\n",
+	     unmatched, depth);
+	free(stack);
+	free(buff);
+
+	return ret;
 }
 
 static int read_profile(FILE *fin, int *not_found)
@@ -243,12 +392,24 @@ static int read_profile(FILE *fin, int *not_found)
 		switch (hdr.type) {
 		case TRACE_CHUNK_FUNCS:
 			/* Ignored at present */
+			if (fseek(fin, hdr.rec_count *
+				  sizeof(struct trace_output_func), SEEK_CUR))
+				return 1;
 			break;
 
 		case TRACE_CHUNK_CALLS:
 			if (read_calls(fin, hdr.rec_count))
 				return 1;
 			break;
+
+		case TRACE_CHUNK_RING:
+			if (read_ring(fin, hdr.rec_count))
+				return 1;
+			break;
+
+		default:
+			error("Unknown chunk type %d\n", hdr.type);
+			return 1;
 		}
 	}
 	return 0;
@@ -471,6 +632,10 @@ static void out_func(ulong func_offset, int is_caller, const char *suffix)
 {
 	struct func_info *func;
 
+	if (func_offset == CALLER_UNKNOWN) {
+		printf("?%s", suffix);
+		return;
+	}
 	func = (is_caller ? find_caller_by_offset : find_func_by_offset)
 		(func_offset);
 
@@ -491,7 +656,7 @@ static void out_func(ulong func_offset, int is_caller, const char *suffix)
  */
 static int make_ftrace(void)
 {
-	struct trace_call *call;
+	struct call_info *call;
 	int missing_count = 0, skip_count = 0;
 	int i;
 
@@ -501,11 +666,8 @@ static int make_ftrace(void)
 		"#              | |      |          |         |\n");
 	for (i = 0, call = call_list; i < call_count; i++, call++) {
 		struct func_info *func = find_func_by_offset(call->func);
-		ulong time = call->flags & FUNCF_TIMESTAMP_MASK;
+		uint64_t time = call->time;
 
-		if (TRACE_CALL_TYPE(call) != FUNCF_ENTRY &&
-		    TRACE_CALL_TYPE(call) != FUNCF_EXIT)
-			continue;
 		if (!func) {
 			warn("Cannot find function at %lx\n",
 			     text_offset + call->func);
@@ -520,8 +682,9 @@ static int make_ftrace(void)
 			continue;
 		}
 
-		printf("%16s-%-5d [01] %lu.%06lu: ", "uboot", 1,
-		       time / 1000000, time % 1000000);
+		printf("%16s-%-5d [01] %llu.%06llu: ", "uboot", 1,
+		       (unsigned long long)time / 1000000,
+		       (unsigned long long)time % 1000000);
 
 		out_func(call->func, 0, " <- ");
 		out_func(call->caller, 1, "\n");
@@ -532,6 +695,195 @@ static int make_ftrace(void)
 	return 0;
 }
 
+/* Get the name of a function to trace, or NULL if it should be left out */
+static const char *traced_func_name(uint32_t offset)
+{
+	struct func_info *func = find_func_by_offset(offset);
+
+	if (!func || !(func->flags & FUNCF_TRACE))
+		return NULL;
+
+	return func->name;
+}
+
+/*
+ * Write the call trace as Chrome trace events, which can be loaded into
+ * chrome://tracing or https://ui.perfetto.dev
+ *
+ * {"traceEvents": [
+ * {"name": "board_init_r", "ph": "B", "pid": 1, "tid": 1, "ts": 1234},
+ * {"name": "board_init_r", "ph": "E", "pid": 1, "tid": 1, "ts": 1240},
+ * ...
+ */
+static int make_chrome(void)
+{
+	struct call_info *call;
+	const char **stack;
+	const char *name;
+	uint64_t time = 0;
+	int depth = 0;
+	bool first = true;
+	int i;
+
+	stack = calloc(call_count + 1, sizeof(*stack));
+	if (!stack) {
+		error("Cannot allocate call stack\n");
+		return -1;
+	}
+	printf("{\"traceEvents\": [");
+	for (i = 0, call = call_list; i < call_count; i++, call++) {
+		time = call->time;
+		if (call->exit) {
+			/* Leave out exits for functions entered earlier */
+			if (!depth)
+				continue;
+			name = stack[--depth];
+		} else {
+			name = traced_func_name(call->func);
+			stack[depth++] = name;
+		}
+		if (!name)
+			continue;
+		printf("%s\n{\"name\": \"%s\", \"cat\": \"u-boot\", \"ph\": \"%c\", \"pid\": 1, \"tid\": 1, \"ts\": %llu}",
+		       first ? "" : ",", name, call->exit ? 'E' : 'B',
+		       (unsigned long long)time);
+		first = false;
+	}
+
+	/* Close any functions which had not exited when the trace was taken */
+	while (depth--) {
+		name = stack[depth];
+		if (!name)
+			continue;
+		printf("%s\n{\"name\": \"%s\", \"cat\": \"u-boot\", \"ph\": \"E\", \"pid\": 1, \"tid\": 1, \"ts\": %llu}",
+		       first ? "" : ",", name, (unsigned long long)time);
+		first = false;
+	}
+	printf("\n],\n\"displayTimeUnit\": \"ns\"}\n");
+	free(stack);
+
+	return 0;
+}
+
+static int h_cmp_stack(const void *v1, const void *v2)
+{
+	const struct stack_time *s1 = v1, *s2 = v2;
+
+	return strcmp(s1->stack, s2->stack);
+}
+
+/* Record the time spent in the function at the top of the call stack */
+static int add_stack_time(struct stack_frame *stack, int depth, uint64_t time,
+			  struct stack_time **listp, int *countp, int *allocp)
+{
+	struct stack_time *item;
+	size_t len = 0;
+	char *ptr;
+	int i;
+
+	for (i = 0; i <= depth; i++)
+		if (stack[i].name)
+			len += strlen(stack[i].name) + 1;
+	if (!len || !time)
+		return 0;
+
+	if (*countp == *allocp) {
+		*allocp = *allocp ? *allocp * 2 : 1024;
+		*listp = realloc(*listp, sizeof(struct stack_time) * *allocp);
+		if (!*listp) {
+			error("Cannot allocate stack list\n");
+			return -1;
+		}
+	}
+	item = &(*listp)[(*countp)++];
+	item->time = time;
+	item->stack = malloc(len);
+	if (!item->stack) {
+		error("Cannot allocate stack\n");
+		return -1;
+	}
+	for (i = 0, ptr = item->stack; i <= depth; i++) {
+		if (stack[i].name)
+			ptr += sprintf(ptr, "%s%s", ptr == item->stack ?
+				       "" : ";", stack[i].name);
+	}
+
+	return 0;
+}
+
+/* Pop the top function off the call stack, recording its time */
+static int exit_frame(struct stack_frame *stack, int depth, uint64_t time,
+		      struct stack_time **listp, int *countp, int *allocp)
+{
+	struct stack_frame *frame = &stack[depth];
+	uint64_t total = time - frame->start;
+
+	if (depth)
+		frame[-1].child_time += total;
+
+	return add_stack_time(stack, depth, total - frame->child_time, listp,
+			      countp, allocp);
+}
+
+/*
+ * Write out the call stacks in the folded format used by flamegraph.pl and
+ * similar tools, with the time spent in each stack in microseconds:
+ *
+ * board_init_r;initr_dm;dm_init_and_scan 1234
+ *
+ * Time spent in functions which are excluded from the trace is counted
+ * against their caller.
+ */
+static int make_flamegraph(void)
+{
+	struct stack_time *list = NULL;
+	struct stack_frame *stack;
+	struct call_info *call;
+	int count = 0, alloced = 0;
+	uint64_t time = 0;
+	int depth = 0;
+	int ret = 0;
+	int i;
+
+	stack = calloc(call_count + 1, sizeof(*stack));
+	if (!stack) {
+		error("Cannot allocate call stack\n");
+		return -1;
+	}
+	for (i = 0, call = call_list; !ret && i < call_count; i++, call++) {
+		time = call->time;
+		if (call->exit) {
+			if (depth)
+				ret = exit_frame(stack, --depth, time, &list,
+						 &count, &alloced);
+		} else {
+			stack[depth].name = traced_func_name(call->func);
+			stack[depth].start = time;
+			stack[depth].child_time = 0;
+			depth++;
+		}
+	}
+	while (!ret && depth--)
+		ret = exit_frame(stack, depth, time, &list, &count, &alloced);
+
+	/* Merge identical stacks */
+	if (!ret)
+		qsort(list, count, sizeof(*list), h_cmp_stack);
+	for (i = 0; i < count; i++) {
+		if (!ret && i + 1 < count &&
+		    !strcmp(list[i].stack, list[i + 1].stack))
+			list[i + 1].time += list[i].time;
+		else if (!ret)
+			printf("%s %llu\n", list[i].stack,
+			       (unsigned long long)list[i].time);
+		free(list[i].stack);
+	}
+	free(list);
+	free(stack);
+
+	return ret;
+}
+
 static int prof_tool(int argc, char *const argv[],
 		     const char *prof_fname, const char *map_fname,
 		     const char *trace_config_fname)
@@ -552,6 +904,10 @@ static int prof_tool(int argc, char *const argv[],
 
 		if (0 == strcmp(cmd, "dump-ftrace"))
 			err = make_ftrace();
+		else if (0 == strcmp(cmd, "dump-chrome"))
+			err = make_chrome();
+		else if (0 == strcmp(cmd, "dump-flamegraph"))
+			err = make_flamegraph();
 		else
 			warn("Unknown command '%s'\n", cmd);
 	}